@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <llvm/Support/SHA1.h>
+#include <string>
+
+/* Content-addressed cache of compiler outputs, kept in a directory.
+ *
+ * An entry is keyed by a hash of everything that decides the output: the
+ * compiler binary, the effective options and the bytes of every input. It
+ * lives at <dir>/<first 2 hex digits>/<remaining digits>. Entries are
+ * written to a temporary file and renamed into place, so processes sharing
+ * one directory never see a partial entry.
+ *
+ * Every lookup appends one byte ('h' or 'm') to <dir>/stats with O_APPEND,
+ * which keeps the counters exact under concurrent compilations.
+ */
+class CompileCache {
+  public:
+    struct Stats {
+        unsigned long hits{0};
+        unsigned long misses{0};
+    };
+
+    // The compiler binary is identified by its size and modification time,
+    // as ccache does by default.
+    explicit CompileCache(std::filesystem::path dir);
+
+    // Add an option to the key.
+    void add(const std::string &data);
+    // Add the contents of an input file to the key. Returns false if the file
+    // cannot be read.
+    bool add_file(const std::filesystem::path &path);
+
+    // Copy the entry to output and count a hit, or count a miss. Must be
+    // called once, after the whole key has been added.
+    bool fetch(const std::filesystem::path &output);
+    // Save output as the entry. Failures are ignored: the cache is only an
+    // accelerator, the output itself is already written.
+    void store(const std::filesystem::path &output);
+
+    Stats get_stats() const;
+
+  private:
+    void record(char event);
+
+    std::filesystem::path dir_;
+    std::filesystem::path entry_;
+    llvm::SHA1 hasher_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+/* Resident batch mode of cminusfc, started with `cminusfc --serve`.
+ *
+ * Requests are read from stdin, one per line: an id chosen by the client,
+ * then the arguments of an ordinary cminusfc run, separated by blanks
+ * (there is no quoting):
+ *
+ *   7 -S -mem2reg foo.cminus -o foo.s
+ *
+ * Each request is compiled in a child forked from the server, at most
+ * `-j <jobs>` at a time. The children skip loading and starting the
+ * compiler, and a request that fails, even by exit() or assert(), ends only
+ * its own child. Replies are written to stdout while the children run,
+ * every line prefixed with the id of its request:
+ *
+ *   7 | <a line of output or diagnostics>
+ *   7 exit <status>
+ *
+ * The exit line comes last; status is 128 + the signal number if the child
+ * was killed. The server quits once stdin is closed and every request has
+ * been answered.
+ */
+int serve(int argc, char **argv, int (*compile)(int argc, char **argv));
@@ -8,43 +8,77 @@
 #include "Type.hpp"
 #include "ast.hpp"
 
-#include <map>
 #include <memory>
-
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+/* Names in scope, with O(1) enter, exit, push and lookup.
+ *
+ * Every distinct name is interned once in an open-addressing table, whose
+ * slot points to the innermost binding of the name. A binding remembers the
+ * binding of the same name it shadows, and the bindings of all scopes form
+ * one stack, so exit() pops the bindings of the innermost scope and puts
+ * back whatever they shadowed.
+ */
 class Scope {
   public:
+    Scope() : slots(16) {}
+
     // enter a new scope
-    void enter() { inner.emplace_back(); }
+    void enter() { scope_begin.push_back(bindings.size()); }
 
     // exit a scope
-    void exit() { inner.pop_back(); }
+    void exit();
 
-    bool in_global() { return inner.size() == 1; }
+    bool in_global() { return scope_begin.size() == 1; }
 
     // push a name to scope
     // return true if successful
     // return false if this name already exits
-    bool push(const std::string& name, Value *val) {
-        auto result = inner[inner.size() - 1].insert({name, val});
-        return result.second;
-    }
+    bool push(std::string_view name, Value *val);
 
-    Value *find(const std::string& name) {
-        for (auto s = inner.rbegin(); s != inner.rend(); s++) {
-            auto iter = s->find(name);
-            if (iter != s->end()) {
-                return iter->second;
-            }
-        }
-
-        // Name not found: handled here?
-        assert(false && "Name not found in scope");
+    Value *find(std::string_view name) {
+        auto val = lookup(name);
+        assert(val && "Name not found in scope");
+        return val;
+    }
 
-        return nullptr;
+    // return nullptr if the name is not bound
+    Value *lookup(std::string_view name) const {
+        auto &slot = slots[find_slot(name, hash(name))];
+        return slot.binding < 0 ? nullptr : bindings[slot.binding].val;
     }
 
   private:
-    std::vector<std::map<std::string, Value *>> inner;
+    struct Slot {
+        std::string name;
+        std::size_t hash = 0;
+        bool used = false;
+        // innermost binding of the name, -1 if it is not bound
+        int binding = -1;
+    };
+    struct Binding {
+        Value *val;
+        unsigned slot;
+        // the binding of the same name this one shadows, or -1
+        int shadowed;
+    };
+
+    static std::size_t hash(std::string_view name) {
+        return std::hash<std::string_view>{}(name);
+    }
+    // the slot of name, or the free slot it would take
+    unsigned find_slot(std::string_view name, std::size_t hash) const;
+    void grow();
+
+    // size is a power of two, at most half of the slots are used
+    std::vector<Slot> slots;
+    unsigned used_slots = 0;
+    std::vector<Binding> bindings;
+    // index in bindings of the first binding of each scope
+    std::vector<unsigned> scope_begin;
 };
 
 class CminusfBuilder : public ASTVisitor {
@@ -83,6 +117,13 @@ class CminusfBuilder : public ASTVisitor {
 
     std::unique_ptr<Module> getModule() { return std::move(module); }
 
+    // Top-level declarations of the other files of the same program
+    using Externals = std::unordered_map<std::string_view, ASTDeclaration *>;
+    // A name this file uses but does not define is looked up in externals
+    // and declared in this module; link_modules() later binds it to the
+    // definition.
+    void set_externals(const Externals *ext) { externals = ext; }
+
   private:
     virtual Value *visit(ASTProgram &) override final;
     virtual Value *visit(ASTNum &) override final;
@@ -101,10 +142,21 @@ class CminusfBuilder : public ASTVisitor {
     virtual Value *visit(ASTTerm &) override final;
     virtual Value *visit(ASTCall &) override final;
 
+    Type *get_var_type(ASTVarDeclaration &node);
+    FunctionType *get_fun_type(ASTFunDeclaration &node);
+    // scope.find(), falling back to the declarations of other files
+    Value *find(std::string_view name);
+
     std::unique_ptr<IRBuilder> builder;
     Scope scope;
     std::unique_ptr<Module> module;
 
+    const Externals *externals = nullptr;
+    // names defined at the top level of this file
+    std::unordered_set<std::string_view> own_names;
+    // declarations made for names of other files
+    std::unordered_map<std::string_view, Value *> extern_decls;
+
     struct {
         unsigned label = 0;
         Function *func = nullptr; // function that is being built
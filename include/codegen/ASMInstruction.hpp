@@ -1,25 +1,152 @@
 #pragma once
 
+#include "Register.hpp"
+#include "StringPool.hpp"
+
 #include <cassert>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
 
-struct ASMInstruction {
-    enum InstType { Instruction, Atrribute, Label, Comment } type;
-    std::string content;
-
-    explicit ASMInstruction(std::string s, InstType ty = Instruction)
-        : type(ty), content(s) {}
-
-    std::string format() const {
-        switch (type) {
-        case ASMInstruction::Instruction:
-        case ASMInstruction::Atrribute:
-            return "\t" + content + "\n";
-        case ASMInstruction::Label:
-            return content + ":\n";
-        case ASMInstruction::Comment:
-            return "# " + content + "\n";
-        }
-        assert(false && "unreachable");
+class Instruction;
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+/* 龙芯指令及汇编伪指令
+ * 助记符和操作数格式见 ASMInstruction.cpp 中的 op_info 表
+ */
+enum class ASMOp : uint8_t {
+    // Arithmetic
+    ADD_W,
+    ADD_D,
+    SUB_W,
+    SUB_D,
+    MUL_W,
+    DIV_W,
+    ADDI_W,
+    ADDI_D,
+    LU12I_W,
+    LU32I_D,
+    LU52I_D,
+    // Logic
+    SLT,
+    OR,
+    NOR,
+    ORI,
+    BSTRPICK_W,
+    BSTRPICK_D,
+    // Memory access
+    LD_B,
+    LD_W,
+    LD_D,
+    ST_B,
+    ST_W,
+    ST_D,
+    FLD_S,
+    FST_S,
+    // Float
+    FADD_S,
+    FSUB_S,
+    FMUL_S,
+    FDIV_S,
+    FCMP_SLT_S,
+    FCMP_SLE_S,
+    FCMP_SEQ_S,
+    FCMP_SNE_S,
+    FFINT_S_W,
+    FTINTRZ_W_S,
+    // Data transfer (greg <-> freg)
+    MOVGR2FR_W,
+    MOVFR2GR_S,
+    // Branch
+    B,
+    BL,
+    BNEZ,
+    JR,
+    // ASM syntax sugar
+    LA_LOCAL,
+    // 伪指令
+    TEXT,
+    SECTION_BSS,
+    GLOBL,
+    TYPE_OBJECT,
+    TYPE_FUNCTION,
+    SIZE,
+    SPACE,
+    // 标签, 注释, 以及以文本给出的指令
+    LABEL,
+    COMMENT,
+    IR_COMMENT,
+    RAW,
+};
+
+// 指令的一个操作数: 寄存器, 立即数或符号 (标签名)
+struct ASMOperand {
+    enum Kind : uint8_t { Register, Immediate, Symbol } kind;
+    union {
+        uint8_t reg;
+        int32_t imm;
+        StringPool::Handle symbol;
+    };
+
+    ASMOperand(const Reg &r);
+    ASMOperand(const FReg &r);
+    ASMOperand(const CFReg &r);
+    ASMOperand(int32_t i) : kind(Immediate), imm(i) {}
+    ASMOperand(int64_t i) : kind(Immediate), imm(static_cast<int32_t>(i)) {
+        assert(i == imm && "immediate out of range");
     }
+    ASMOperand(unsigned i) : kind(Immediate), imm(static_cast<int32_t>(i)) {
+        assert(imm >= 0 && "immediate out of range");
+    }
+    // 符号需在打印前一直有效, 一般取自 Module 的 StringPool
+    ASMOperand(StringPool::Handle s) : kind(Symbol), symbol(s) {}
+};
+
+/* 一条汇编指令
+ *
+ * 只记录操作码, 寄存器编号, 立即数和符号, 在打印时才按 op_info
+ * 中的格式生成文本. IR_COMMENT 记录的是 IR 指令本身, 打印时输出
+ * 它的文本, 因此打印前 Module 不能被修改或销毁.
+ */
+struct ASMInstruction {
+    // 以文本给出的指令的种类
+    enum InstType { Instruction, Atrribute, Label, Comment };
+
+    // 寄存器编号: 通用寄存器 0-31, 浮点寄存器 32-63, 条件标志寄存器 64-71
+    static constexpr uint8_t FREG_BASE = 32;
+    static constexpr uint8_t CFREG_BASE = 64;
+    static constexpr unsigned MAX_REGS = 3;
+    static constexpr unsigned MAX_IMMS = 2;
+
+    ASMOp op;
+    uint8_t regs[MAX_REGS];
+    int32_t imms[MAX_IMMS];
+    union {
+        StringPool::Handle symbol;
+        ::Instruction *ir;
+    };
+
+    ASMInstruction(ASMOp op, std::initializer_list<ASMOperand> operands);
+    // 以 IR 指令为内容的注释, 用于调试
+    explicit ASMInstruction(::Instruction *inst)
+        : op(ASMOp::IR_COMMENT), regs(), imms(), ir(inst) {}
+
+    void print(llvm::raw_ostream &os) const;
+    std::string format() const;
+
+    // 机器码的字节数, 伪指令, 标签和注释为 0
+    unsigned get_size() const;
+    /* 编码为机器码, 返回写入 code 的指令条数
+     * offset 为跳转目标相对本指令的字节偏移. 需要重定位的跳转传入 0,
+     * la.local 的地址总是留给重定位填写
+     */
+    unsigned encode(uint32_t code[2], int32_t offset = 0) const;
 };
+
+inline ASMOperand::ASMOperand(const Reg &r) : kind(Register), reg(r.id) {}
+inline ASMOperand::ASMOperand(const FReg &r)
+    : kind(Register), reg(ASMInstruction::FREG_BASE + r.id) {}
+inline ASMOperand::ASMOperand(const CFReg &r)
+    : kind(Register), reg(ASMInstruction::CFREG_BASE + r.id) {}
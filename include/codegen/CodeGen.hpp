@@ -4,30 +4,31 @@
 #include "Module.hpp"
 #include "Register.hpp"
 #include <unordered_map>
+#include <vector>
 
 class CodeGen {
   public:
     explicit CodeGen(Module *module) : m(module) {}
 
+    // 生成的汇编只在这里格式化一次, 直接写入 os
+    void print(llvm::raw_ostream &os) const;
     std::string print() const;
+    // 直接编码为 ELF 可重定位目标文件, 见 ObjectWriter.hpp
+    bool emit_object(llvm::raw_ostream &os, std::string &err) const;
 
     void run();
 
-    template <class... Args> void append_inst(Args... arg) {
-        output.emplace_back(arg...);
+    void append_inst(ASMOp op,
+                     std::initializer_list<ASMOperand> operands = {}) {
+        output.emplace_back(op, operands);
     }
 
+    // 以文本形式给出的指令, 文本会被保存在 Module 的 StringPool 中
+    void append_inst(const std::string &content,
+                     ASMInstruction::InstType ty = ASMInstruction::Instruction);
     void
     append_inst(const char *inst, std::initializer_list<std::string> args,
-                ASMInstruction::InstType ty = ASMInstruction::Instruction) {
-        auto content = std::string(inst) + " ";
-        for (const auto &arg : args) {
-            content += arg + ", ";
-        }
-        content.pop_back();
-        content.pop_back();
-        output.emplace_back(content, ty);
-    }
+                ASMInstruction::InstType ty = ASMInstruction::Instruction);
 
   private:
     void allocate();
@@ -64,14 +65,15 @@ class CodeGen {
     void gen_fptosi();
     void gen_epilogue();
 
-    static std::string label_name(BasicBlock *bb) {
-        return "." + bb->get_parent()->get_name() + "_" + bb->get_name();
+    static StringPool::Handle label_name(BasicBlock *bb) {
+        return &bb->get_asm_label();
     }
 
     struct {
         /* 随着ir遍历设置 */
         Function *func{nullptr};    // 当前函数
         Instruction *inst{nullptr}; // 当前指令
+        StringPool::Handle exit_label{nullptr}; // 当前函数的出口标签
         /* 在allocate()中设置 */
         unsigned frame_size{0}; // 当前函数的栈帧大小
         std::unordered_map<Value *, int> offset_map{}; // 指针相对 fp 的偏移
@@ -79,6 +81,7 @@ class CodeGen {
         void clear() {
             func = nullptr;
             inst = nullptr;
+            exit_label = nullptr;
             frame_size = 0;
             offset_map.clear();
         }
@@ -86,5 +89,5 @@ class CodeGen {
     } context;
 
     Module *m;
-    std::list<ASMInstruction> output;
+    std::vector<ASMInstruction> output;
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ASMInstruction.hpp"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+/* 将 CodeGen 生成的指令直接编码为 LoongArch ELF64 可重定位目标文件
+ *
+ * 目标文件包含 .text, .bss, .symtab 以及 .rela.text 等节, 可与其他
+ * 目标文件 (如 io.c 编译得到的 io.o) 一起交给链接器.
+ * - 同一函数内的 b 和 bnez 直接填写偏移
+ * - bl 使用 R_LARCH_B26 重定位
+ * - la.local 展开为 pcalau12i + addi.d, 使用 R_LARCH_PCALA_HI20/LO12 重定位
+ * 不支持以文本给出的指令 (ASMOp::RAW), 遇到时不写入任何内容, 在 err 中
+ * 给出原因并返回 false.
+ */
+bool write_object(const std::vector<ASMInstruction> &insts,
+                  llvm::raw_ostream &os, std::string &err);
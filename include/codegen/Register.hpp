@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cassert>
-#include <string>
 
 /* General-purpose Register Convention:
  * Name         Alias       Meaning
@@ -30,7 +29,7 @@ struct Reg {
     explicit Reg(unsigned i) : id(i) { assert(i <= 31); }
     bool operator==(const Reg &other) { return id == other.id; }
 
-    std::string print() const;
+    const char *print() const;
 
     static Reg zero() { return Reg(0); }
     static Reg ra() { return Reg(1); }
@@ -59,7 +58,7 @@ struct FReg {
     explicit FReg(unsigned i) : id(i) { assert(i <= 31); }
     bool operator==(const FReg &other) { return id == other.id; }
 
-    std::string print() const;
+    const char *print() const;
 
     static FReg fa(unsigned i) {
         assert(0 <= i and i <= 7);
@@ -81,5 +80,5 @@ struct CFReg {
     explicit CFReg(unsigned i) : id(i) { assert(i <= 7); }
     bool operator==(const CFReg &other) { return id == other.id; }
 
-    std::string print() const { return "$fcc" + std::to_string(id); }
+    const char *print() const;
 };
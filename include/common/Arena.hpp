@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/* Bump/slab allocator owned by a Module, or by an AST for its nodes.
+ *
+ * All IR nodes (Instruction, BasicBlock, Function, GlobalVariable) are carved
+ * out of large slabs instead of being allocated one by one on the heap.
+ * Erased nodes are pushed to a free list keyed by their size class, so the
+ * next node of the same class reuses the slot. All slabs are released in one
+ * go when the owning Module is destroyed.
+ */
+class Arena {
+  public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+    ~Arena();
+
+    void *allocate(std::size_t size, std::size_t align);
+    // return a node of `size` bytes to its free list
+    void deallocate(void *ptr, std::size_t size);
+
+    template <typename T> void *allocate() {
+        return allocate(sizeof(T), alignof(T));
+    }
+    template <typename T> void deallocate(T *ptr) {
+        deallocate(ptr, sizeof(T));
+    }
+
+  private:
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+    static constexpr std::size_t SIZE_CLASS_ALIGN = alignof(std::max_align_t);
+    static constexpr std::size_t NUM_SIZE_CLASSES = 32;
+
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    static std::size_t size_class(std::size_t size) {
+        return (size + SIZE_CLASS_ALIGN - 1) / SIZE_CLASS_ALIGN;
+    }
+
+    void *allocate_slow(std::size_t bytes);
+
+    char *cur_{nullptr};
+    char *end_{nullptr};
+    std::vector<void *> slabs_;
+    std::array<FreeNode *, NUM_SIZE_CLASSES> free_lists_{};
+};
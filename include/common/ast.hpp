@@ -3,10 +3,18 @@
 extern "C" {
 #include "syntax_tree.h"
 extern syntax_tree *parse(const char *input);
+// lex with the hand-written scanner in fast_lexer.c instead of flex
+extern syntax_tree *parse_fast(const char *input);
 }
+#include "Arena.hpp"
 #include "User.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 enum CminusType { TYPE_INT, TYPE_FLOAT, TYPE_VOID };
@@ -66,41 +74,84 @@ struct ASTCall;
 
 class ASTVisitor;
 
+// The children of a node: a contiguous array in the arena of the AST.
+template <typename T> class ASTList {
+  public:
+    ASTList() = default;
+    ASTList(T **data, std::size_t size) : data_(data), size_(size) {}
+
+    T **begin() const { return data_; }
+    T **end() const { return data_ + size_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T *operator[](std::size_t i) const { return data_[i]; }
+
+  private:
+    T **data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
 class AST {
   public:
     AST() = delete;
+    // Convert a syntax tree of parse() and free it. Only test_ast goes this
+    // way; the compiler builds its AST with parse_ast().
     AST(syntax_tree *);
-    AST(AST &&tree) {
-        root = tree.root;
-        tree.root = nullptr;
-    };
-    ASTProgram *get_root() { return root.get(); }
+    AST(AST &&tree) = default;
+    ASTProgram *get_root() { return root; }
     void run_visitor(ASTVisitor &visitor);
 
+    // Nodes, child arrays and identifiers live in the arena of the tree.
+    // Nothing is destroyed on its own: the arena is released at once with
+    // the AST, so nodes hold no owning members.
+    template <typename T> T *create() {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "AST nodes are never destroyed");
+        return new (arena->allocate<T>()) T();
+    }
+    template <typename T> ASTList<T> create_list(const std::vector<T *> &v) {
+        if (v.empty())
+            return {};
+        auto data = static_cast<T **>(
+            arena->allocate(v.size() * sizeof(T *), alignof(T *)));
+        std::copy(v.begin(), v.end(), data);
+        return {data, v.size()};
+    }
+    std::string_view create_id(std::string_view text);
+
   private:
+    friend AST parse_ast(const char *input, bool fast_lexer,
+                         syntax_tree *tree);
+    // an empty tree for parse_ast() to fill
+    explicit AST(std::unique_ptr<Arena> arena) : arena(std::move(arena)) {}
+
     ASTNode *transform_node_iter(syntax_tree_node *);
-    std::shared_ptr<ASTProgram> root = nullptr;
+    // a unique_ptr, so that nodes stay put when the AST is moved
+    std::unique_ptr<Arena> arena;
+    ASTProgram *root = nullptr;
 };
 
+// Parse the file at input straight into an AST, with the grammar in
+// ast_analyzer.y. Tokens come from fast_lexer.c if fast_lexer is set. The
+// syntax tree of parse() is built into tree as well if it is not null.
+AST parse_ast(const char *input, bool fast_lexer = false,
+              syntax_tree *tree = nullptr);
+
 struct ASTNode {
     virtual Value *accept(ASTVisitor &) = 0;
-    virtual ~ASTNode() = default;
 };
 
 struct ASTProgram : ASTNode {
     virtual Value *accept(ASTVisitor &) override final;
-    virtual ~ASTProgram() = default;
-    std::vector<std::shared_ptr<ASTDeclaration>> declarations;
+    ASTList<ASTDeclaration> declarations;
 };
 
 struct ASTDeclaration : ASTNode {
-    virtual ~ASTDeclaration() = default;
     CminusType type;
-    std::string id;
+    std::string_view id;
 };
 
 struct ASTFactor : ASTNode {
-    virtual ~ASTFactor() = default;
 };
 
 struct ASTNum : ASTFactor {
@@ -114,98 +165,97 @@ struct ASTNum : ASTFactor {
 
 struct ASTVarDeclaration : ASTDeclaration {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTNum> num;
+    ASTNum *num = nullptr;
 };
 
 struct ASTFunDeclaration : ASTDeclaration {
     virtual Value *accept(ASTVisitor &) override final;
-    std::vector<std::shared_ptr<ASTParam>> params;
-    std::shared_ptr<ASTCompoundStmt> compound_stmt;
+    ASTList<ASTParam> params;
+    ASTCompoundStmt *compound_stmt = nullptr;
 };
 
 struct ASTParam : ASTNode {
     virtual Value *accept(ASTVisitor &) override final;
     CminusType type;
-    std::string id;
+    std::string_view id;
     // true if it is array param
     bool isarray;
 };
 
 struct ASTStatement : ASTNode {
-    virtual ~ASTStatement() = default;
 };
 
 struct ASTCompoundStmt : ASTStatement {
     virtual Value *accept(ASTVisitor &) override final;
-    std::vector<std::shared_ptr<ASTVarDeclaration>> local_declarations;
-    std::vector<std::shared_ptr<ASTStatement>> statement_list;
+    ASTList<ASTVarDeclaration> local_declarations;
+    ASTList<ASTStatement> statement_list;
 };
 
 struct ASTExpressionStmt : ASTStatement {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTExpression> expression;
+    ASTExpression *expression = nullptr;
 };
 
 struct ASTSelectionStmt : ASTStatement {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTExpression> expression;
-    std::shared_ptr<ASTStatement> if_statement;
+    ASTExpression *expression = nullptr;
+    ASTStatement *if_statement = nullptr;
     // should be nullptr if no else structure exists
-    std::shared_ptr<ASTStatement> else_statement;
+    ASTStatement *else_statement = nullptr;
 };
 
 struct ASTIterationStmt : ASTStatement {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTExpression> expression;
-    std::shared_ptr<ASTStatement> statement;
+    ASTExpression *expression = nullptr;
+    ASTStatement *statement = nullptr;
 };
 
 struct ASTReturnStmt : ASTStatement {
     virtual Value *accept(ASTVisitor &) override final;
     // should be nullptr if return void
-    std::shared_ptr<ASTExpression> expression;
+    ASTExpression *expression = nullptr;
 };
 
 struct ASTExpression : ASTFactor {};
 
 struct ASTAssignExpression : ASTExpression {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTVar> var;
-    std::shared_ptr<ASTExpression> expression;
+    ASTVar *var = nullptr;
+    ASTExpression *expression = nullptr;
 };
 
 struct ASTSimpleExpression : ASTExpression {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTAdditiveExpression> additive_expression_l;
-    std::shared_ptr<ASTAdditiveExpression> additive_expression_r;
+    ASTAdditiveExpression *additive_expression_l = nullptr;
+    ASTAdditiveExpression *additive_expression_r = nullptr;
     RelOp op;
 };
 
 struct ASTVar : ASTFactor {
     virtual Value *accept(ASTVisitor &) override final;
-    std::string id;
+    std::string_view id;
     // nullptr if var is of int type
-    std::shared_ptr<ASTExpression> expression;
+    ASTExpression *expression = nullptr;
 };
 
 struct ASTAdditiveExpression : ASTNode {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTAdditiveExpression> additive_expression;
+    ASTAdditiveExpression *additive_expression = nullptr;
     AddOp op;
-    std::shared_ptr<ASTTerm> term;
+    ASTTerm *term = nullptr;
 };
 
 struct ASTTerm : ASTNode {
     virtual Value *accept(ASTVisitor &) override final;
-    std::shared_ptr<ASTTerm> term;
+    ASTTerm *term = nullptr;
     MulOp op;
-    std::shared_ptr<ASTFactor> factor;
+    ASTFactor *factor = nullptr;
 };
 
 struct ASTCall : ASTFactor {
     virtual Value *accept(ASTVisitor &) override final;
-    std::string id;
-    std::vector<std::shared_ptr<ASTExpression>> args;
+    std::string_view id;
+    ASTList<ASTExpression> args;
 };
 
 class ASTVisitor {
@@ -0,0 +1,103 @@
+#ifndef __CMINUSGRAMMAR_H__
+#define __CMINUSGRAMMAR_H__
+
+/* What the grammar in ast_analyzer.y shares with the C code around it: the
+ * token kinds returned by the lexers, the state of one parse, and the kinds
+ * of the syntax tree nodes built for the parser of lab 1.
+ */
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fast_lexer.h"
+#include "syntax_tree.h"
+
+// Token kinds, numbered the way bison numbers the %token declarations of
+// ast_analyzer.y. 0 is the end of the input.
+enum cminus_token {
+	ERROR = 258,
+	ID,
+	ADD, SUB, MUL, DIV, GT, GEQ, LT, LEQ, EQ, NEQ, ASSIGN, // Operators
+	INTEGER, FLOATPOINT, // Literal values
+	INT, FLOAT, VOID, IF, ELSE, WHILE, RETURN, // C keywords
+	SEMICOLON, COMMA, LPAREN, RPAREN, LBRACKET, RBRACKET, LBRACE, RBRACE, // ; , ( ) [ ] { }
+};
+
+// Kinds of the inner nodes of a syntax tree. Token nodes take the token kind
+// (ID, INT, ...) instead, which is above every NODE_ value.
+enum syntax_node_kind {
+	NODE_PROGRAM = 1,
+	NODE_DECLARATION_LIST,
+	NODE_DECLARATION,
+	NODE_VAR_DECLARATION,
+	NODE_TYPE_SPECIFIER,
+	NODE_FUN_DECLARATION,
+	NODE_PARAMS,
+	NODE_PARAM_LIST,
+	NODE_PARAM,
+	NODE_COMPOUND_STMT,
+	NODE_LOCAL_DECLARATIONS,
+	NODE_STATEMENT_LIST,
+	NODE_STATEMENT,
+	NODE_EXPRESSION_STMT,
+	NODE_SELECTION_STMT,
+	NODE_ITERATION_STMT,
+	NODE_RETURN_STMT,
+	NODE_EXPRESSION,
+	NODE_VAR,
+	NODE_SIMPLE_EXPRESSION,
+	NODE_RELOP,
+	NODE_ADDITIVE_EXPRESSION,
+	NODE_ADDOP,
+	NODE_TERM,
+	NODE_MULOP,
+	NODE_FACTOR,
+	NODE_INTEGER,
+	NODE_FLOAT,
+	NODE_CALL,
+	NODE_ARGS,
+	NODE_ARG_LIST,
+	NODE_EPSILON,
+};
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+
+// All the state of one parse. Nothing is global, so independent files can be
+// parsed by several threads at once.
+typedef struct {
+	// the syntax tree being built, NULL if only the AST is wanted
+	syntax_tree * tree;
+	// position of the last token, updated by the lexer
+	int lines;
+	int pos_start;
+	int pos_end;
+	// the flex scanner, or the hand-written lexer if fast_lex is set
+	yyscan_t scanner;
+	fast_lexer * fast_lex;
+} parse_context;
+
+// the reentrant scanner generated from lexical_analyzer.l
+int yylex(yyscan_t scanner);
+int yylex_init_extra(parse_context * ctx, yyscan_t * scanner);
+void yyset_in(FILE * in, yyscan_t scanner);
+char * yyget_text(yyscan_t scanner);
+int yyget_leng(yyscan_t scanner);
+int yylex_destroy(yyscan_t scanner);
+
+// Parse the file at input_path, or stdin if it is NULL, into a syntax tree.
+// The tree has no root if the input has a syntax error.
+syntax_tree * parse(const char * input_path);
+// Same as parse(), with the tokens of fast_lexer.c instead of flex.
+syntax_tree * parse_fast(const char * input_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* cminus_grammar.h */
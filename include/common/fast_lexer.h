@@ -0,0 +1,34 @@
+#ifndef __FASTLEXER_H__
+#define __FASTLEXER_H__
+
+/* Hand-written replacement for the flex scanner in lexical_analyzer.l.
+ *
+ * The input is mapped into memory and tokens point into it, so no token
+ * text is copied. Blanks, identifiers, numbers and comments are scanned with
+ * SSE2/AVX2 when the CPU has them. Token kinds, the longest-match rules and
+ * the line/column bookkeeping are the same as the flex scanner's.
+ */
+
+typedef struct {
+	int type;          // token kind from cminus_grammar.h, 0 at end of input
+	int len;
+	const char *text;  // not NUL-terminated, valid until fast_lexer_close()
+	// the scanner's `lines`, `pos_start` and `pos_end` after this token
+	int line;
+	int pos_start;
+	int pos_end;
+} fast_token;
+
+typedef struct _fast_lexer fast_lexer;
+
+// Open input_path, or stdin if it is NULL. Returns NULL with errno set if
+// the input cannot be read.
+fast_lexer * fast_lexer_open(const char * input_path);
+// Scan the next token into tok and return its kind.
+int fast_lexer_next(fast_lexer * lexer, fast_token * tok);
+void fast_lexer_close(fast_lexer * lexer);
+// Scan with "scalar", "sse2" or "avx2" code instead of the best one the CPU
+// has, to test them against each other. Returns -1 if it is not available.
+int fast_lexer_use_scanner(fast_lexer * lexer, const char * name);
+
+#endif /* fast_lexer.h */
@@ -3,27 +3,37 @@
 
 #include <stdio.h>
 
-#define SYNTAX_TREE_NODE_NAME_MAX 30
-
 struct _syntax_tree_node {
-	struct _syntax_tree_node * parent;
-	struct _syntax_tree_node * children[10];
+	// exactly children_num entries
+	struct _syntax_tree_node ** children;
 	int children_num;
 
-	char name[SYNTAX_TREE_NODE_NAME_MAX];
+	const char * name;
+	// set by the grammar to tell nodes apart without comparing names,
+	// 0 unless it does
+	int kind;
 };
 typedef struct _syntax_tree_node syntax_tree_node;
 
-syntax_tree_node * new_anon_syntax_tree_node();
-syntax_tree_node * new_syntax_tree_node(const char * name);
-int syntax_tree_add_child(syntax_tree_node * parent, syntax_tree_node * child);
-void del_syntax_tree_node(syntax_tree_node * node, int recursive);
+struct _syntax_tree_chunk;
 
 struct _syntax_tree {
 	syntax_tree_node * root;
+
+	// nodes, child arrays and token text are bump-allocated from a list of
+	// chunks, which del_syntax_tree() releases all at once
+	struct _syntax_tree_chunk * chunks;
+	char * cur;
+	char * end;
 };
 typedef struct _syntax_tree syntax_tree;
 
+// A node with room for children_num children, which the caller fills in.
+// The name is not copied and must outlive the tree, e.g. a string literal.
+syntax_tree_node * new_syntax_tree_node(syntax_tree * tree, const char * name, int children_num);
+// A leaf for a token. The len bytes of text are copied into the tree.
+syntax_tree_node * new_syntax_tree_token(syntax_tree * tree, const char * text, int len);
+
 syntax_tree* new_syntax_tree();
 void del_syntax_tree(syntax_tree * tree);
 void print_syntax_tree(FILE * fout, syntax_tree * tree);
@@ -3,7 +3,7 @@
 #include "Instruction.hpp"
 #include "Value.hpp"
 
-#include <list>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
 #include <set>
@@ -15,21 +15,25 @@ class Module;
 
 class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
   public:
+    using BBList = llvm::SmallVector<BasicBlock *, 2>;
+
     ~BasicBlock() = default;
     static BasicBlock *create(Module *m, const std::string &name,
-                              Function *parent) {
-        auto prefix = name.empty() ? "" : "label_";
-        return new BasicBlock(m, prefix + name, parent);
+                              Function *parent);
+
+    static bool classof(const Value *v) {
+        return v->get_value_id() == BasicBlockVal;
     }
 
     /****************api about cfg****************/
-    std::list<BasicBlock *> &get_pre_basic_blocks() { return pre_bbs_; }
-    std::list<BasicBlock *> &get_succ_basic_blocks() { return succ_bbs_; }
-
-    void add_pre_basic_block(BasicBlock *bb) { pre_bbs_.push_back(bb); }
-    void add_succ_basic_block(BasicBlock *bb) { succ_bbs_.push_back(bb); }
-    void remove_pre_basic_block(BasicBlock *bb) { pre_bbs_.remove(bb); }
-    void remove_succ_basic_block(BasicBlock *bb) { succ_bbs_.remove(bb); }
+    // Edges follow the BranchInst terminators: they are added when a branch
+    // is created, moved when a branch target changes and dropped when a
+    // branch is erased.
+    const BBList &get_pre_basic_blocks() const { return pre_bbs_; }
+    const BBList &get_succ_basic_blocks() const { return succ_bbs_; }
+    // Reorder the predecessors, preds must hold the same blocks as
+    // get_pre_basic_blocks(). Used to restore the order of a loaded module.
+    void reorder_pre_basic_blocks(const BBList &preds);
 
     // If the Block is terminated by ret/br
     bool is_terminated() const;
@@ -38,7 +42,7 @@ class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
 
     /****************api about Instruction****************/
     void add_instruction(Instruction *instr);
-    void add_instr_begin(Instruction *instr) { instr_list_.push_front(instr); }
+    void add_instr_begin(Instruction *instr);
     void erase_instr(Instruction *instr) { instr_list_.erase(instr); }
 
     llvm::ilist<Instruction> &get_instructions() { return instr_list_; }
@@ -50,14 +54,43 @@ class BasicBlock : public Value, public llvm::ilist_node<BasicBlock> {
     Module *get_module();
     void erase_from_parent();
 
-    virtual std::string print() override;
+    // Whether this block or one of its instructions still has no name, see
+    // Function::set_instr_name()
+    bool needs_numbering() const { return needs_numbering_; }
+    void mark_needs_numbering();
+    void clear_needs_numbering() { needs_numbering_ = false; }
+
+    // ".<function>_<block>", the label of this block in assembly, interned
+    // on first use
+    const std::string &get_asm_label();
+
+    // dense index in the parent function, see Function::renumber()
+    unsigned get_index() const { return index_; }
+
+    virtual void print(llvm::raw_ostream &os) override;
 
   private:
+    friend class BranchInst;
+    friend class Function;
+
     BasicBlock(const BasicBlock &) = delete;
     explicit BasicBlock(Module *m, const std::string &name, Function *parent);
 
-    std::list<BasicBlock *> pre_bbs_;
-    std::list<BasicBlock *> succ_bbs_;
+    // add/remove one edge from -> to, and invalidate the cached CFG order
+    static void add_edge(BasicBlock *from, BasicBlock *to);
+    static void remove_edge(BasicBlock *from, BasicBlock *to);
+
+    BBList pre_bbs_;
+    BBList succ_bbs_;
     llvm::ilist<Instruction> instr_list_;
     Function *parent_;
+    const std::string *asm_label_{nullptr};
+    bool needs_numbering_{false};
+    unsigned index_{0};
+};
+
+namespace llvm {
+template <> struct ilist_alloc_traits<BasicBlock> {
+    static void deleteNode(BasicBlock *bb);
 };
+} // namespace llvm
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <memory>
+#include <string>
+
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+/* Binary serialization of a Module, stored in .lirbc files.
+ *
+ * The file is a flat stream of little-endian 32-bit words:
+ *
+ *   header     magic, version and the size of every table below
+ *   strings    value names, each as a byte length followed by the bytes
+ *   types      element types come before the types built from them
+ *   constants  array elements come before the arrays
+ *   functions  name and function type of every function
+ *   globals    name, element type, constness and initializer
+ *   bodies     for each function: argument and block names, the type of
+ *              every instruction, then opcode, name and operands of every
+ *              instruction in layout order
+ *
+ * Values are referenced by dense index. Module-level values are numbered
+ * functions first, then globals, then constants. Values local to a function
+ * are numbered arguments first, then blocks, then instructions (see
+ * Function::renumber()), and have the top bit of the index set.
+ */
+
+constexpr const char *BITCODE_EXTENSION = ".lirbc";
+
+void write_bitcode(Module *m, llvm::raw_ostream &os);
+
+// Map the file at path into memory and rebuild the module from it. On
+// failure, returns nullptr and describes the problem in err.
+std::unique_ptr<Module> read_bitcode(const std::string &path,
+                                     std::string &err);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cassert>
+
+/* LLVM-style RTTI for LightIR values.
+ *
+ * Every class in the Value hierarchy provides
+ *     static bool classof(const Value *v);
+ * which checks the ValueID stored in the Value, so isa<> is a plain integer
+ * compare instead of a dynamic_cast.
+ *
+ *     if (auto *ci = dyn_cast<ConstantInt>(v))
+ *         ... ci->get_value() ...
+ */
+
+template <typename To, typename From> inline bool isa(const From *v) {
+    assert(v && "isa<> used on a null pointer");
+    return To::classof(v);
+}
+
+template <typename To, typename From> inline To *cast(From *v) {
+    assert(isa<To>(v) && "cast<Ty>() argument of incompatible type!");
+    return static_cast<To *>(v);
+}
+
+template <typename To, typename From> inline const To *cast(const From *v) {
+    assert(isa<To>(v) && "cast<Ty>() argument of incompatible type!");
+    return static_cast<const To *>(v);
+}
+
+template <typename To, typename From> inline To *dyn_cast(From *v) {
+    return isa<To>(v) ? static_cast<To *>(v) : nullptr;
+}
+
+template <typename To, typename From>
+inline const To *dyn_cast(const From *v) {
+    return isa<To>(v) ? static_cast<const To *>(v) : nullptr;
+}
+
+// same as dyn_cast<>, but accepts a null pointer
+template <typename To, typename From> inline To *dyn_cast_or_null(From *v) {
+    return (v and isa<To>(v)) ? static_cast<To *>(v) : nullptr;
+}
@@ -8,20 +8,31 @@ class Constant : public User {
   private:
     // int value;
   public:
-    Constant(Type *ty, const std::string &name = "") : User(ty, name) {}
+    Constant(ValueID vid, Type *ty, const std::string &name = "")
+        : User(vid, ty, name) {}
     ~Constant() = default;
+
+    static bool classof(const Value *v) {
+        return v->get_value_id() >= ConstantIntVal and
+               v->get_value_id() <= ConstantArrayVal;
+    }
 };
 
 class ConstantInt : public Constant {
   private:
     int value_;
-    ConstantInt(Type *ty, int val) : Constant(ty, ""), value_(val) {}
+    ConstantInt(Type *ty, int val)
+        : Constant(ConstantIntVal, ty, ""), value_(val) {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_id() == ConstantIntVal;
+    }
+
     int get_value() { return value_; }
     static ConstantInt *get(int val, Module *m);
     static ConstantInt *get(bool val, Module *m);
-    virtual std::string print() override;
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ConstantArray : public Constant {
@@ -33,6 +44,10 @@ class ConstantArray : public Constant {
   public:
     ~ConstantArray() = default;
 
+    static bool classof(const Value *v) {
+        return v->get_value_id() == ConstantArrayVal;
+    }
+
     Constant *get_element_value(int index);
 
     unsigned get_size_of_array() { return const_array.size(); }
@@ -40,25 +55,34 @@ class ConstantArray : public Constant {
     static ConstantArray *get(ArrayType *ty,
                               const std::vector<Constant *> &val);
 
-    virtual std::string print() override;
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ConstantZero : public Constant {
   private:
-    ConstantZero(Type *ty) : Constant(ty, "") {}
+    ConstantZero(Type *ty) : Constant(ConstantZeroVal, ty, "") {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_id() == ConstantZeroVal;
+    }
+
     static ConstantZero *get(Type *ty, Module *m);
-    virtual std::string print() override;
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ConstantFP : public Constant {
   private:
     float val_;
-    ConstantFP(Type *ty, float val) : Constant(ty, ""), val_(val) {}
+    ConstantFP(Type *ty, float val)
+        : Constant(ConstantFPVal, ty, ""), val_(val) {}
 
   public:
+    static bool classof(const Value *v) {
+        return v->get_value_id() == ConstantFPVal;
+    }
+
     static ConstantFP *get(float val, Module *m);
     float get_value() { return val_; }
-    virtual std::string print() override;
+    virtual void print(llvm::raw_ostream &os) override;
 };
@@ -21,11 +21,14 @@ class FunctionType;
 class Function : public Value, public llvm::ilist_node<Function> {
   public:
     Function(const Function &) = delete;
-    Function(FunctionType *ty, const std::string &name, Module *parent);
-    ~Function() = default;
+    ~Function();
     static Function *create(FunctionType *ty, const std::string &name,
                             Module *parent);
 
+    static bool classof(const Value *v) {
+        return v->get_value_id() == FunctionVal;
+    }
+
     FunctionType *get_function_type() const;
     Type *get_return_type() const;
 
@@ -44,25 +47,60 @@ class Function : public Value, public llvm::ilist_node<Function> {
 
     bool is_declaration() { return basic_blocks_.empty(); }
 
+    // Give every unnamed argument, block and instruction a numbered name.
+    // Only blocks changed since the last call are visited.
     void set_instr_name();
-    std::string print();
+    void mark_needs_numbering() { needs_numbering_ = true; }
+    // Keep set_instr_name() from giving out the number of a name that was
+    // read back from a file, such as "op7"
+    void reserve_name(const std::string &name);
+
+    // Blocks reachable from the entry in reverse post order, cached until
+    // the CFG changes
+    const std::vector<BasicBlock *> &get_reverse_post_order();
+    void invalidate_cfg() { rpo_valid_ = false; }
+
+    // Give blocks and instructions dense indices 0..n-1 in layout order, so
+    // that analyses can keep their state in vectors and bit vectors. The
+    // indices are stale once blocks or instructions are added or removed.
+    void renumber();
+    unsigned get_num_block_indices() const { return num_block_indices_; }
+    unsigned get_num_instr_indices() const { return num_instr_indices_; }
+    virtual void print(llvm::raw_ostream &os) override;
 
   private:
+    Function(FunctionType *ty, const std::string &name, Module *parent);
+
     llvm::ilist<BasicBlock> basic_blocks_;
     std::list<Argument> arguments_;
     Module *parent_;
-    unsigned seq_cnt_; // print use
+    unsigned seq_cnt_; // next number to give out
+    bool needs_numbering_{false};
+    std::vector<BasicBlock *> rpo_;
+    bool rpo_valid_{false};
+    unsigned num_block_indices_{0};
+    unsigned num_instr_indices_{0};
 };
 
+namespace llvm {
+template <> struct ilist_alloc_traits<Function> {
+    static void deleteNode(Function *func);
+};
+} // namespace llvm
+
 // Argument of Function, does not contain actual value
 class Argument : public Value {
   public:
     Argument(const Argument &) = delete;
     explicit Argument(Type *ty, const std::string &name = "",
                       Function *f = nullptr, unsigned arg_no = 0)
-        : Value(ty, name), parent_(f), arg_no_(arg_no) {}
+        : Value(ArgumentVal, ty, name), parent_(f), arg_no_(arg_no) {}
     virtual ~Argument() {}
 
+    static bool classof(const Value *v) {
+        return v->get_value_id() == ArgumentVal;
+    }
+
     inline const Function *get_parent() const { return parent_; }
     inline Function *get_parent() { return parent_; }
 
@@ -72,7 +110,7 @@ class Argument : public Value {
         return arg_no_;
     }
 
-    virtual std::string print() override;
+    virtual void print(llvm::raw_ostream &os) override;
 
   private:
     Function *parent_;
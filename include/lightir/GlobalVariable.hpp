@@ -3,12 +3,15 @@
 #include "Constant.hpp"
 #include "User.hpp"
 
+#include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
+
 class Module;
 class GlobalVariable : public User, public llvm::ilist_node<GlobalVariable> {
   private:
     bool is_const_;
     Constant *init_val_;
+    Module *parent_;
     GlobalVariable(std::string name, Module *m, Type *ty, bool is_const,
                    Constant *init = nullptr);
 
@@ -17,7 +20,18 @@ class GlobalVariable : public User, public llvm::ilist_node<GlobalVariable> {
     static GlobalVariable *create(std::string name, Module *m, Type *ty,
                                   bool is_const, Constant *init);
     virtual ~GlobalVariable() = default;
+
+    static bool classof(const Value *v) {
+        return v->get_value_id() == GlobalVariableVal;
+    }
     Constant *get_init() { return init_val_; }
     bool is_const() { return is_const_; }
-    std::string print();
+    Module *get_parent() const { return parent_; }
+    virtual void print(llvm::raw_ostream &os) override;
+};
+
+namespace llvm {
+template <> struct ilist_alloc_traits<GlobalVariable> {
+    static void deleteNode(GlobalVariable *gv);
 };
+} // namespace llvm
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <memory>
+#include <string>
+
+/* Parser for the textual LightIR written by Module::print, usually saved in
+ * .ll files.
+ *
+ * Only the dialect produced by the printer is accepted: global variables,
+ * function declarations and definitions, and the instructions of
+ * Instruction::OpID. Every value keeps the name it is printed with, and the
+ * "; preds = " comment of a block restores the order of its predecessors,
+ * so printing the parsed module gives back the same text.
+ */
+
+constexpr const char *IR_EXTENSION = ".ll";
+
+// Read the file at path and build a module from it. On failure, returns
+// nullptr and describes the problem, with its line and column, in err.
+std::unique_ptr<Module> parse_ir(const std::string &path, std::string &err);
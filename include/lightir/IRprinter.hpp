@@ -10,5 +10,10 @@
 #include "User.hpp"
 #include "Value.hpp"
 
-std::string print_as_op(Value *v, bool print_ty);
-std::string print_instr_op_name(Instruction::OpID);
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+// Print v as an operand: "@name", "%name" or the constant itself
+void print_as_op(llvm::raw_ostream &os, Value *v, bool print_ty);
+const char *print_instr_op_name(Instruction::OpID);
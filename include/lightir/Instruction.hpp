@@ -3,8 +3,12 @@
 #include "Type.hpp"
 #include "User.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
+#include <new>
+#include <tuple>
 
 class BasicBlock;
 class Function;
@@ -67,39 +71,53 @@ class Instruction : public User, public llvm::ilist_node<Instruction> {
     Function *get_function();
     Module *get_module();
 
-    OpID get_instr_type() const { return op_id_; }
+    OpID get_instr_type() const {
+        return static_cast<OpID>(get_value_id() - InstructionVal);
+    }
     std::string get_instr_op_name() const;
 
+    // Build an instruction of the given opcode and result type from operands
+    // read back from a file, and insert it into bb. Returns nullptr instead
+    // of asserting if the operands do not fit the opcode.
+    static Instruction *create(OpID id, Type *ty,
+                               const std::vector<Value *> &ops,
+                               BasicBlock *bb);
+
     bool is_void() {
-        return ((op_id_ == ret) || (op_id_ == br) || (op_id_ == store) ||
-                (op_id_ == call && this->get_type()->is_void_type()));
+        auto op = get_instr_type();
+        return ((op == ret) || (op == br) || (op == store) ||
+                (op == call && this->get_type()->is_void_type()));
     }
 
-    bool is_phi() const { return op_id_ == phi; }
-    bool is_store() const { return op_id_ == store; }
-    bool is_alloca() const { return op_id_ == alloca; }
-    bool is_ret() const { return op_id_ == ret; }
-    bool is_load() const { return op_id_ == load; }
-    bool is_br() const { return op_id_ == br; }
-
-    bool is_add() const { return op_id_ == add; }
-    bool is_sub() const { return op_id_ == sub; }
-    bool is_mul() const { return op_id_ == mul; }
-    bool is_div() const { return op_id_ == sdiv; }
-
-    bool is_fadd() const { return op_id_ == fadd; }
-    bool is_fsub() const { return op_id_ == fsub; }
-    bool is_fmul() const { return op_id_ == fmul; }
-    bool is_fdiv() const { return op_id_ == fdiv; }
-    bool is_fp2si() const { return op_id_ == fptosi; }
-    bool is_si2fp() const { return op_id_ == sitofp; }
-
-    bool is_cmp() const { return ge <= op_id_ and op_id_ <= ne; }
-    bool is_fcmp() const { return fge <= op_id_ and op_id_ <= fne; }
+    bool is_phi() const { return get_instr_type() == phi; }
+    bool is_store() const { return get_instr_type() == store; }
+    bool is_alloca() const { return get_instr_type() == alloca; }
+    bool is_ret() const { return get_instr_type() == ret; }
+    bool is_load() const { return get_instr_type() == load; }
+    bool is_br() const { return get_instr_type() == br; }
+
+    bool is_add() const { return get_instr_type() == add; }
+    bool is_sub() const { return get_instr_type() == sub; }
+    bool is_mul() const { return get_instr_type() == mul; }
+    bool is_div() const { return get_instr_type() == sdiv; }
+
+    bool is_fadd() const { return get_instr_type() == fadd; }
+    bool is_fsub() const { return get_instr_type() == fsub; }
+    bool is_fmul() const { return get_instr_type() == fmul; }
+    bool is_fdiv() const { return get_instr_type() == fdiv; }
+    bool is_fp2si() const { return get_instr_type() == fptosi; }
+    bool is_si2fp() const { return get_instr_type() == sitofp; }
+
+    bool is_cmp() const {
+        return ge <= get_instr_type() and get_instr_type() <= ne;
+    }
+    bool is_fcmp() const {
+        return fge <= get_instr_type() and get_instr_type() <= fne;
+    }
 
-    bool is_call() const { return op_id_ == call; }
-    bool is_gep() const { return op_id_ == getelementptr; }
-    bool is_zext() const { return op_id_ == zext; }
+    bool is_call() const { return get_instr_type() == call; }
+    bool is_gep() const { return get_instr_type() == getelementptr; }
+    bool is_zext() const { return get_instr_type() == zext; }
 
     bool isBinary() const {
         return (is_add() || is_sub() || is_mul() || is_div() || is_fadd() ||
@@ -109,15 +127,45 @@ class Instruction : public User, public llvm::ilist_node<Instruction> {
 
     bool isTerminator() const { return is_br() || is_ret(); }
 
+    // dense index in the parent function, see Function::renumber()
+    unsigned get_index() const { return index_; }
+
+    static bool classof(const Value *v) {
+        return v->get_value_id() >= InstructionVal;
+    }
+
+  protected:
+    // whether v is an instruction with an opcode in [first, last]
+    static bool is_instr_in(const Value *v, OpID first, OpID last) {
+        auto vid = v->get_value_id();
+        return InstructionVal + first <= vid and vid <= InstructionVal + last;
+    }
+
+    // Get memory for a new instruction from the arena of bb's module
+    static void *allocate(std::size_t size, BasicBlock *bb);
+
   private:
-    OpID op_id_;
+    friend class Function;
+
     BasicBlock *parent_;
+    unsigned index_{0};
 };
 
+// Erased instructions go back to the module arena instead of the heap
+namespace llvm {
+template <> struct ilist_alloc_traits<Instruction> {
+    static void deleteNode(Instruction *instr);
+};
+} // namespace llvm
+
 template <typename Inst> class BaseInst : public Instruction {
   protected:
+    // every create_xxx passes the BasicBlock to insert into as last argument
     template <typename... Args> static Inst *create(Args &&...args) {
-        return new Inst(std::forward<Args>(args)...);
+        BasicBlock *bb =
+            std::get<sizeof...(Args) - 1>(std::forward_as_tuple(args...));
+        auto mem = Instruction::allocate(sizeof(Inst), bb);
+        return new (mem) Inst(std::forward<Args>(args)...);
     }
 
     template <typename... Args>
@@ -136,7 +184,9 @@ class IBinaryInst : public BaseInst<IBinaryInst> {
     static IBinaryInst *create_mul(Value *v1, Value *v2, BasicBlock *bb);
     static IBinaryInst *create_sdiv(Value *v1, Value *v2, BasicBlock *bb);
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, add, sdiv); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class FBinaryInst : public BaseInst<FBinaryInst> {
@@ -151,7 +201,9 @@ class FBinaryInst : public BaseInst<FBinaryInst> {
     static FBinaryInst *create_fmul(Value *v1, Value *v2, BasicBlock *bb);
     static FBinaryInst *create_fdiv(Value *v1, Value *v2, BasicBlock *bb);
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, fadd, fdiv); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ICmpInst : public BaseInst<ICmpInst> {
@@ -168,7 +220,9 @@ class ICmpInst : public BaseInst<ICmpInst> {
     static ICmpInst *create_eq(Value *v1, Value *v2, BasicBlock *bb);
     static ICmpInst *create_ne(Value *v1, Value *v2, BasicBlock *bb);
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, ge, ne); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class FCmpInst : public BaseInst<FCmpInst> {
@@ -185,7 +239,9 @@ class FCmpInst : public BaseInst<FCmpInst> {
     static FCmpInst *create_feq(Value *v1, Value *v2, BasicBlock *bb);
     static FCmpInst *create_fne(Value *v1, Value *v2, BasicBlock *bb);
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, fge, fne); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class CallInst : public BaseInst<CallInst> {
@@ -199,7 +255,9 @@ class CallInst : public BaseInst<CallInst> {
                                  BasicBlock *bb);
     FunctionType *get_function_type() const;
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, call, call); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class BranchInst : public BaseInst<BranchInst> {
@@ -217,7 +275,14 @@ class BranchInst : public BaseInst<BranchInst> {
 
     bool is_cond_br() const { return get_num_operand() == 3; }
 
-    virtual std::string print() override;
+    // keep the CFG edges in sync after an operand changed from old_val to
+    // new_val (nullptr if it was removed), called by User::set_operand(),
+    // remove_operand() and remove_all_operands()
+    void replace_target(Value *old_val, Value *new_val);
+
+    static bool classof(const Value *v) { return is_instr_in(v, br, br); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ReturnInst : public BaseInst<ReturnInst> {
@@ -231,7 +296,9 @@ class ReturnInst : public BaseInst<ReturnInst> {
     static ReturnInst *create_void_ret(BasicBlock *bb);
     bool is_void_ret() const;
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, ret, ret); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class GetElementPtrInst : public BaseInst<GetElementPtrInst> {
@@ -246,7 +313,11 @@ class GetElementPtrInst : public BaseInst<GetElementPtrInst> {
                                          BasicBlock *bb);
     Type *get_element_type() const;
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) {
+        return is_instr_in(v, getelementptr, getelementptr);
+    }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class StoreInst : public BaseInst<StoreInst> {
@@ -261,7 +332,9 @@ class StoreInst : public BaseInst<StoreInst> {
     Value *get_rval() { return this->get_operand(0); }
     Value *get_lval() { return this->get_operand(1); }
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, store, store); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class LoadInst : public BaseInst<LoadInst> {
@@ -276,7 +349,9 @@ class LoadInst : public BaseInst<LoadInst> {
     Value *get_lval() const { return this->get_operand(0); }
     Type *get_load_type() const { return get_type(); };
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, load, load); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class AllocaInst : public BaseInst<AllocaInst> {
@@ -292,7 +367,11 @@ class AllocaInst : public BaseInst<AllocaInst> {
         return get_type()->get_pointer_element_type();
     };
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) {
+        return is_instr_in(v, alloca, alloca);
+    }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class ZextInst : public BaseInst<ZextInst> {
@@ -307,7 +386,9 @@ class ZextInst : public BaseInst<ZextInst> {
 
     Type *get_dest_type() const { return get_type(); };
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) { return is_instr_in(v, zext, zext); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class FpToSiInst : public BaseInst<FpToSiInst> {
@@ -322,7 +403,11 @@ class FpToSiInst : public BaseInst<FpToSiInst> {
 
     Type *get_dest_type() const { return get_type(); };
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) {
+        return is_instr_in(v, fptosi, fptosi);
+    }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class SiToFpInst : public BaseInst<SiToFpInst> {
@@ -336,7 +421,11 @@ class SiToFpInst : public BaseInst<SiToFpInst> {
 
     Type *get_dest_type() const { return get_type(); };
 
-    virtual std::string print() override;
+    static bool classof(const Value *v) {
+        return is_instr_in(v, sitofp, sitofp);
+    }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
 
 class PhiInst : public BaseInst<PhiInst> {
@@ -355,5 +444,8 @@ class PhiInst : public BaseInst<PhiInst> {
         this->add_operand(val);
         this->add_operand(pre_bb);
     }
-    virtual std::string print() override;
+
+    static bool classof(const Value *v) { return is_instr_in(v, phi, phi); }
+
+    virtual void print(llvm::raw_ostream &os) override;
 };
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Module.hpp"
+
+#include <string>
+
+/* Copy the functions and global variables of src into dst.
+ *
+ * Symbols are resolved by name. A function declared in one module binds to
+ * its definition in the other, while defining it in both is an error.
+ * Global variables of cminus are zero-initialized and behave like C common
+ * symbols: globals of the same name and type are merged into one.
+ *
+ * src is left unchanged and may be destroyed afterwards. On failure, returns
+ * false and describes the conflict in err; dst may then be partially linked.
+ */
+bool link_modules(Module *dst, Module *src, std::string &err);
@@ -1,17 +1,27 @@
 #pragma once
 
+#include "Arena.hpp"
+#include "Constant.hpp"
 #include "Function.hpp"
 #include "GlobalVariable.hpp"
 #include "Instruction.hpp"
+#include "StringPool.hpp"
 #include "Type.hpp"
 #include "Value.hpp"
 
-#include <list>
+#include <array>
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/Hashing.h>
 #include <llvm/ADT/ilist.h>
 #include <llvm/ADT/ilist_node.h>
-#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class GlobalVariable;
 class Function;
@@ -37,10 +47,85 @@ class Module {
     void add_global_variable(GlobalVariable *g);
     llvm::ilist<GlobalVariable> &get_global_variable();
 
+    // Memory pool of all IR nodes in this module
+    Arena &get_arena() { return arena_; }
+    // Names of all values, labels and symbols in this module
+    StringPool &get_string_pool() { return string_pool_; }
+
     void set_print_name();
+    void print(llvm::raw_ostream &os);
     std::string print();
 
   private:
+    friend class ConstantInt;
+    friend class ConstantFP;
+    friend class ConstantZero;
+    friend class ConstantArray;
+
+    using ConstantArrayKey = std::pair<ArrayType *, std::vector<Constant *>>;
+    struct ConstantArrayKeyHash {
+        std::size_t operator()(const ConstantArrayKey &key) const {
+            return llvm::hash_combine(
+                key.first,
+                llvm::hash_combine_range(key.second.begin(), key.second.end()));
+        }
+    };
+
+    // Lets the FunctionType set be probed with (result, params) directly,
+    // without building a FunctionType or copying the parameter vector
+    struct FunctionTypeKeyInfo {
+        struct KeyTy {
+            Type *result;
+            llvm::ArrayRef<Type *> params;
+
+            KeyTy(Type *result, llvm::ArrayRef<Type *> params)
+                : result(result), params(params) {}
+            explicit KeyTy(const FunctionType *ft)
+                : result(ft->get_return_type()), params(ft->get_params()) {}
+            bool operator==(const KeyTy &other) const {
+                return result == other.result and params == other.params;
+            }
+        };
+
+        static FunctionType *getEmptyKey() {
+            return llvm::DenseMapInfo<FunctionType *>::getEmptyKey();
+        }
+        static FunctionType *getTombstoneKey() {
+            return llvm::DenseMapInfo<FunctionType *>::getTombstoneKey();
+        }
+        static unsigned getHashValue(const KeyTy &key) {
+            return llvm::hash_combine(
+                key.result,
+                llvm::hash_combine_range(key.params.begin(), key.params.end()));
+        }
+        static unsigned getHashValue(const FunctionType *ft) {
+            return getHashValue(KeyTy(ft));
+        }
+        static bool isEqual(const KeyTy &lhs, const FunctionType *rhs) {
+            if (rhs == getEmptyKey() or rhs == getTombstoneKey())
+                return false;
+            return lhs == KeyTy(rhs);
+        }
+        static bool isEqual(const FunctionType *lhs, const FunctionType *rhs) {
+            return lhs == rhs;
+        }
+    };
+
+    // Must outlive the node lists below, so declare them first
+    Arena arena_;
+    StringPool string_pool_;
+
+    // Uniqued constants of this module, keyed by value (float by its bits).
+    // Declared before the node lists so that all their uses are gone by the
+    // time they are destroyed.
+    std::unordered_map<int, std::unique_ptr<ConstantInt>> int_consts_;
+    std::array<std::unique_ptr<ConstantInt>, 2> bool_consts_;
+    std::unordered_map<uint32_t, std::unique_ptr<ConstantFP>> float_consts_;
+    std::unordered_map<Type *, std::unique_ptr<ConstantZero>> zero_consts_;
+    std::unordered_map<ConstantArrayKey, std::unique_ptr<ConstantArray>,
+                       ConstantArrayKeyHash>
+        array_consts_;
+
     // The global variables in the module
     llvm::ilist<GlobalVariable> global_list_;
     // The functions in the module
@@ -51,9 +136,11 @@ class Module {
     std::unique_ptr<Type> label_ty_;
     std::unique_ptr<Type> void_ty_;
     std::unique_ptr<FloatType> float32_ty_;
-    std::map<Type *, std::unique_ptr<PointerType>> pointer_map_;
-    std::map<std::pair<Type *, int>, std::unique_ptr<ArrayType>> array_map_;
-    std::map<std::pair<Type *, std::vector<Type *>>,
-             std::unique_ptr<FunctionType>>
-        function_map_;
+    // Derived types, uniqued so that type identity is a pointer compare.
+    // Each get_xxx_type() call does a single hash probe.
+    llvm::DenseMap<Type *, std::unique_ptr<PointerType>> pointer_map_;
+    llvm::DenseMap<std::pair<Type *, unsigned>, std::unique_ptr<ArrayType>>
+        array_map_;
+    llvm::DenseSet<FunctionType *, FunctionTypeKeyInfo> function_set_;
+    std::vector<std::unique_ptr<FunctionType>> function_types_;
 };
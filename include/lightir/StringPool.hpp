@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+/* Interned strings owned by a Module.
+ *
+ * Each distinct string (value names, labels, symbols) is stored once, and
+ * users keep a handle to the pooled copy. A handle stays valid until the
+ * owning Module is destroyed, and equal strings share the same handle.
+ */
+class StringPool {
+  public:
+    using Handle = const std::string *;
+
+    StringPool() : empty_(&*pool_.insert("").first) {}
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    Handle intern(const std::string &str) {
+        // most values are unnamed, skip hashing for them
+        if (str.empty())
+            return empty_;
+        return &*pool_.insert(str).first;
+    }
+    Handle empty() const { return empty_; }
+
+  private:
+    // node-based, so the address of an element never changes
+    std::unordered_set<std::string> pool_;
+    Handle empty_;
+};
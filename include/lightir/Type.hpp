@@ -3,6 +3,10 @@
 #include <iostream>
 #include <vector>
 
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
 class Module;
 class IntegerType;
 class FunctionType;
@@ -44,6 +48,7 @@ class Type {
     Module *get_module() const { return m_; }
     unsigned get_size() const;
 
+    void print(llvm::raw_ostream &os) const;
     std::string print() const;
 
   private:
@@ -73,6 +78,7 @@ class FunctionType : public Type {
     unsigned get_num_of_args() const;
 
     Type *get_param_type(unsigned i) const;
+    const std::vector<Type *> &get_params() const { return args_; }
     std::vector<Type *>::iterator param_begin() { return args_.begin(); }
     std::vector<Type *>::iterator param_end() { return args_.end(); }
     Type *get_return_type() const;
@@ -103,6 +109,8 @@ class PointerType : public Type {
     PointerType(Type *contained);
     Type *get_element_type() const { return contained_; }
 
+    static bool is_valid_element_type(Type *ty);
+
     static PointerType *get(Type *contained);
 
   private:
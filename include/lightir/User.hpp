@@ -2,18 +2,74 @@
 
 #include "Value.hpp"
 
-#include <vector>
+#include <cassert>
+#include <llvm/ADT/SmallVector.h>
+
+// A view over the operands of a User, iterated as Value *
+class OperandList {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *const *;
+        using reference = Value *const &;
+
+        explicit iterator(const Use *use = nullptr) : use_(use) {}
+        reference operator*() const { return use_->value_; }
+        iterator &operator++() {
+            ++use_;
+            return *this;
+        }
+        iterator operator++(int) {
+            auto old = *this;
+            ++use_;
+            return old;
+        }
+        bool operator==(const iterator &other) const {
+            return use_ == other.use_;
+        }
+        bool operator!=(const iterator &other) const {
+            return use_ != other.use_;
+        }
+
+      private:
+        const Use *use_;
+    };
+
+    OperandList(const Use *begin, const Use *end) : begin_(begin), end_(end) {}
+    iterator begin() const { return iterator(begin_); }
+    iterator end() const { return iterator(end_); }
+    std::size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+
+  private:
+    const Use *begin_;
+    const Use *end_;
+};
 
 class User : public Value {
   public:
-    User(Type *ty, const std::string &name = "") : Value(ty, name){};
+    // Most instructions have at most 3 operands (cond br); only phi, call and
+    // getelementptr may spill their operands to the heap.
+    static constexpr unsigned NUM_INLINE_OPERANDS = 3;
+
+    User(ValueID vid, Type *ty, const std::string &name = "")
+        : Value(vid, ty, name){};
     virtual ~User() { remove_all_operands(); }
 
-    const std::vector<Value *> &get_operands() const { return operands_; }
+    OperandList get_operands() const {
+        return OperandList(operands_.data(),
+                           operands_.data() + operands_.size());
+    }
     unsigned get_num_operand() const { return operands_.size(); }
 
     // start from 0
-    Value *get_operand(unsigned i) const { return operands_.at(i); };
+    Value *get_operand(unsigned i) const {
+        assert(i < operands_.size() && "get_operand out of index");
+        return operands_[i].get();
+    };
     // start from 0
     void set_operand(unsigned i, Value *v);
     void add_operand(Value *v);
@@ -21,21 +77,16 @@ class User : public Value {
     void remove_all_operands();
     void remove_operand(unsigned i);
 
-  private:
-    std::vector<Value *> operands_; // operands of this value
-};
-
-/* For example: op = func(a, b)
- *  for a: Use(op, 0)
- *  for b: Use(op, 1)
- */
-struct Use {
-    User *val_;       // used by whom
-    unsigned arg_no_; // the no. of operand
+    static bool classof(const Value *v) {
+        auto vid = v->get_value_id();
+        return vid == GlobalVariableVal or vid >= ConstantIntVal;
+    }
 
-    Use(User *val, unsigned no) : val_(val), arg_no_(no) {}
+  protected:
+    // make room for n operands at once when the count is known up front
+    void reserve_operands(unsigned n) { operands_.reserve(n); }
 
-    bool operator==(const Use &other) const {
-        return val_ == other.val_ and arg_no_ == other.arg_no_;
-    }
+  private:
+    // operands of this value, stored inline when there are only a few
+    llvm::SmallVector<Use, NUM_INLINE_OPERANDS> operands_;
 };
@@ -1,37 +1,150 @@
 #pragma once
 
+#include "Casting.hpp"
+
+#include <cstddef>
 #include <functional>
 #include <iostream>
-#include <list>
+#include <iterator>
 #include <string>
 
 class Type;
 class Value;
 class User;
-struct Use;
+
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+/* For example: op = func(a, b)
+ *  for a: Use(op, 0)
+ *  for b: Use(op, 1)
+ *
+ * Every operand slot of a User is a Use. All the Uses of one Value are
+ * chained into an intrusive doubly-linked list owned by that Value, so a Use
+ * can be unlinked in O(1) without searching the list.
+ */
+struct Use {
+    User *val_;       // used by whom
+    unsigned arg_no_; // the no. of operand
+
+    Use(User *val, unsigned no) : val_(val), arg_no_(no) {}
+    // Operand storage may be reallocated: the moved Use takes over the
+    // position of `other` in the use list.
+    Use(Use &&other) noexcept;
+    Use(const Use &) = delete;
+    Use &operator=(const Use &) = delete;
+    ~Use() { set(nullptr); }
+
+    // the used value
+    Value *get() const { return value_; }
+    // unlink from the current value and append to the use list of `v`
+    void set(Value *v);
+
+    Use *get_next() const { return next_; }
+
+    bool operator==(const Use &other) const {
+        return val_ == other.val_ and arg_no_ == other.arg_no_;
+    }
+
+  private:
+    friend class OperandList;
+    void unlink();
+
+    Value *value_{nullptr};
+    Use *prev_{nullptr};
+    Use *next_{nullptr};
+};
+
+// A view over the use list of a Value, iterated in insertion order
+class UseList {
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Use;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Use *;
+        using reference = const Use &;
+
+        explicit iterator(const Use *use = nullptr) : use_(use) {}
+        reference operator*() const { return *use_; }
+        pointer operator->() const { return use_; }
+        iterator &operator++() {
+            use_ = use_->get_next();
+            return *this;
+        }
+        iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const iterator &other) const {
+            return use_ == other.use_;
+        }
+        bool operator!=(const iterator &other) const {
+            return use_ != other.use_;
+        }
+
+      private:
+        const Use *use_;
+    };
+
+    explicit UseList(const Use *head) : head_(head) {}
+    iterator begin() const { return iterator(head_); }
+    iterator end() const { return iterator(); }
+    bool empty() const { return head_ == nullptr; }
+    // linear in the number of uses
+    std::size_t size() const { return std::distance(begin(), end()); }
+
+  private:
+    const Use *head_;
+};
 
 class Value {
   public:
-    explicit Value(Type *ty, const std::string &name = "")
-        : type_(ty), name_(name){};
+    // The concrete class of a Value, checked by isa<>/cast<>/dyn_cast<>.
+    // An instruction has the ID InstructionVal + its Instruction::OpID.
+    enum ValueID : unsigned {
+        ArgumentVal,
+        BasicBlockVal,
+        FunctionVal,
+        GlobalVariableVal,
+        // Constants
+        ConstantIntVal,
+        ConstantFPVal,
+        ConstantZeroVal,
+        ConstantArrayVal,
+        // Instructions, must be the last one
+        InstructionVal
+    };
+
+    // the name is interned in the string pool of the module of `ty`
+    explicit Value(ValueID vid, Type *ty, const std::string &name = "");
     virtual ~Value() { replace_all_use_with(nullptr); }
 
-    std::string get_name() const { return name_; };
+    const std::string &get_name() const { return *name_; };
     Type *get_type() const { return type_; }
-    const std::list<Use> &get_use_list() const { return use_list_; }
+    ValueID get_value_id() const { return vid_; }
+    UseList get_use_list() const { return UseList(use_head_); }
 
-    bool set_name(std::string name);
-
-    void add_use(User *user, unsigned arg_no);
-    void remove_use(User *user, unsigned arg_no);
+    bool set_name(const std::string &name);
 
     void replace_all_use_with(Value *new_val);
-    void replace_use_with_if(Value *new_val, std::function<bool(Use)> pred);
+    void replace_use_with_if(Value *new_val,
+                             std::function<bool(const Use &)> pred);
 
-    virtual std::string print() = 0;
+    // Write the textual IR of this value to os
+    virtual void print(llvm::raw_ostream &os) = 0;
+    // Thin wrapper over print(os), for logs and comments
+    std::string print();
 
   private:
+    friend struct Use;
+
+    ValueID vid_;
     Type *type_;
-    std::list<Use> use_list_; // who use this value
-    std::string name_;        // should we put name field here ?
+    Use *use_head_{nullptr}; // who use this value
+    Use *use_tail_{nullptr};
+    const std::string *name_; // interned, see StringPool
 };
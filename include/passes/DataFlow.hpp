@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BasicBlock.hpp"
+#include "Function.hpp"
+
+#include <algorithm>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/SparseBitVector.h>
+#include <utility>
+#include <vector>
+
+enum class DataFlowDirection { Forward, Backward };
+
+/**
+ * 基于基本块的迭代数据流求解器
+ *
+ * Problem 描述一个具体的分析, 例如:
+ *
+ *   struct LiveVariables {
+ *       using Domain = llvm::BitVector; // 或 llvm::SparseBitVector<>
+ *       static constexpr auto direction = DataFlowDirection::Backward;
+ *       // 流入入口块 (前向) 或流出出口块 (后向) 的值
+ *       Domain boundary();
+ *       // 格的顶元, 即 meet 的单位元, 其余块以它为初值
+ *       Domain top();
+ *       void meet(Domain &lhs, const Domain &rhs);
+ *       // 由块的输入计算块的输出
+ *       Domain transfer(BasicBlock *bb, const Domain &in);
+ *   };
+ *
+ * 块按逆后序 (后向分析为后序) 访问, 只有输入发生变化的块才会被重新计算.
+ * 状态按 BasicBlock::get_index() 存放在 vector 中, 求解前会重新编号.
+ * 从入口不可达的块不参与求解, 其值保持为 top().
+ */
+template <typename Problem> class DataFlowSolver {
+  public:
+    using Domain = typename Problem::Domain;
+    static constexpr bool forward =
+        Problem::direction == DataFlowDirection::Forward;
+
+    DataFlowSolver(Function *func, Problem &problem)
+        : func_(func), problem_(problem) {}
+
+    void solve();
+
+    // 按程序顺序, bb 开始处 / 结束处的值
+    const Domain &get_block_entry(BasicBlock *bb) const {
+        return forward ? in_[bb->get_index()] : out_[bb->get_index()];
+    }
+    const Domain &get_block_exit(BasicBlock *bb) const {
+        return forward ? out_[bb->get_index()] : in_[bb->get_index()];
+    }
+
+  private:
+    static constexpr unsigned UNREACHABLE = ~0u;
+
+    // 沿数据流方向的前驱 / 后继
+    static const BasicBlock::BBList &flow_preds(BasicBlock *bb) {
+        return forward ? bb->get_pre_basic_blocks()
+                       : bb->get_succ_basic_blocks();
+    }
+    static const BasicBlock::BBList &flow_succs(BasicBlock *bb) {
+        return forward ? bb->get_succ_basic_blocks()
+                       : bb->get_pre_basic_blocks();
+    }
+
+    Function *func_;
+    Problem &problem_;
+    // 以 BasicBlock::get_index() 为下标, in/out 按数据流方向
+    std::vector<Domain> in_;
+    std::vector<Domain> out_;
+};
+
+template <typename Problem> void DataFlowSolver<Problem>::solve() {
+    func_->renumber();
+    auto num_blocks = func_->get_num_block_indices();
+    in_.assign(num_blocks, problem_.top());
+    out_.assign(num_blocks, problem_.top());
+    if (func_->is_declaration())
+        return;
+
+    std::vector<BasicBlock *> order = func_->get_reverse_post_order();
+    if (not forward)
+        std::reverse(order.begin(), order.end());
+    std::vector<unsigned> position(num_blocks, UNREACHABLE);
+    for (unsigned i = 0; i < order.size(); i++)
+        position[order[i]->get_index()] = i;
+
+    // 工作表: 每次取序中最靠前的待处理块
+    llvm::BitVector pending(order.size(), true);
+    auto entry = func_->get_entry_block();
+    for (int i = pending.find_first(); i != -1; i = pending.find_first()) {
+        pending.reset(i);
+        auto bb = order[i];
+        auto idx = bb->get_index();
+
+        bool is_boundary =
+            forward ? bb == entry : bb->get_succ_basic_blocks().empty();
+        Domain in = is_boundary ? problem_.boundary() : problem_.top();
+        for (auto pred : flow_preds(bb))
+            problem_.meet(in, out_[pred->get_index()]);
+        in_[idx] = std::move(in);
+
+        Domain out = problem_.transfer(bb, in_[idx]);
+        if (out == out_[idx])
+            continue;
+        out_[idx] = std::move(out);
+        for (auto succ : flow_succs(bb)) {
+            auto pos = position[succ->get_index()];
+            if (pos != UNREACHABLE)
+                pending.set(pos);
+        }
+    }
+}
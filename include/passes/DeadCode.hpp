@@ -3,6 +3,7 @@
 #include "FuncInfo.hpp"
 #include "PassManager.hpp"
 
+#include <llvm/ADT/BitVector.h>
 #include <unordered_set>
 
 /**
@@ -19,7 +20,7 @@ class DeadCode : public Pass {
     std::shared_ptr<FuncInfo> func_info;
     int ins_count{0}; // 用以衡量死代码消除的性能
     std::deque<Instruction *> work_list{};
-    std::unordered_map<Instruction *, bool> marked{};
+    llvm::BitVector marked{}; // 以 Instruction::get_index() 为下标
 
     void mark(Function *func);
     void mark(Instruction *ins);
@@ -3,6 +3,7 @@
 #include "BasicBlock.hpp"
 #include "PassManager.hpp"
 
+#include <llvm/Support/raw_ostream.h>
 #include <map>
 #include <set>
 
@@ -23,6 +24,9 @@ class Dominators : public Pass {
         return domSucc.at(bb);
     }
 
+    // 按布局顺序打印每个块的直接支配者和支配边界
+    void print(llvm::raw_ostream& os);
+
    private:
     void create_idom(Function* f);
     void create_dominance_frontier(Function* f);
@@ -30,9 +34,6 @@ class Dominators : public Pass {
 
     // FIXME: 补充需要的函数
 
-    bool bb_same(BasicBlock* bb1, BasicBlock* bb2);
-    bool bb_dom(BasicBlock* bb1, BasicBlock* bb2);
-
     std::map<BasicBlock*, BasicBlock*> idom{};  // 直接支配
     std::map<BasicBlock*, BBSet> domFront{};    // 支配边界
     std::map<BasicBlock*, BBSet> domSucc{};     // 支配树中的后继
@@ -31,10 +31,10 @@ class Mem2Reg : public Pass {
     void rename(BasicBlock* bb);
 
     static inline bool is_global_variable(Value* l_val) {
-        return dynamic_cast<GlobalVariable*>(l_val) != nullptr;
+        return isa<GlobalVariable>(l_val);
     }
     static inline bool is_gep_instr(Value* l_val) {
-        return dynamic_cast<GetElementPtrInst*>(l_val) != nullptr;
+        return isa<GetElementPtrInst>(l_val);
     }
 
     static inline bool is_valid_ptr(Value* l_val) {
@@ -0,0 +1,94 @@
+#include "CompileCache.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+CompileCache::CompileCache(fs::path dir) : dir_(std::move(dir)) {
+    std::error_code ec;
+    auto exe = fs::read_symlink("/proc/self/exe", ec);
+    if (ec) {
+        // no procfs, every build of the compiler shares the entries
+        add("cminusfc");
+        return;
+    }
+    auto size = fs::file_size(exe, ec);
+    auto mtime = fs::last_write_time(exe, ec).time_since_epoch();
+    add(exe.string());
+    add(std::to_string(size));
+    add(std::to_string(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(mtime).count()));
+}
+
+void CompileCache::add(const std::string &data) {
+    // length-prefixed, so that adjacent fields cannot run into each other
+    hasher_.update(std::to_string(data.size()) + ":");
+    hasher_.update(data);
+}
+
+bool CompileCache::add_file(const fs::path &path) {
+    auto buffer = llvm::MemoryBuffer::getFile(path.string());
+    if (not buffer)
+        return false;
+    add(path.extension().string());
+    hasher_.update(std::to_string((*buffer)->getBufferSize()) + ":");
+    hasher_.update((*buffer)->getBuffer());
+    return true;
+}
+
+bool CompileCache::fetch(const fs::path &output) {
+    auto key = llvm::toHex(hasher_.final(), true);
+    entry_ = dir_ / key.substr(0, 2) / key.substr(2);
+
+    std::error_code ec;
+    fs::copy_file(entry_, output, fs::copy_options::overwrite_existing, ec);
+    record(ec ? 'm' : 'h');
+    return not ec;
+}
+
+void CompileCache::store(const fs::path &output) {
+    assert(not entry_.empty() && "store before fetch");
+    std::error_code ec;
+    fs::create_directories(entry_.parent_path(), ec);
+    if (ec)
+        return;
+    // unique per process, rename() then replaces the entry atomically
+    auto tmp = entry_;
+    tmp += ".tmp." + std::to_string(getpid());
+    fs::copy_file(output, tmp, fs::copy_options::overwrite_existing, ec);
+    if (not ec)
+        fs::rename(tmp, entry_, ec);
+    if (ec)
+        fs::remove(tmp, ec);
+}
+
+CompileCache::Stats CompileCache::get_stats() const {
+    Stats stats;
+    std::ifstream in(dir_ / "stats", std::ios::binary);
+    char event;
+    while (in.get(event)) {
+        if (event == 'h')
+            stats.hits++;
+        else if (event == 'm')
+            stats.misses++;
+    }
+    return stats;
+}
+
+void CompileCache::record(char event) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    int fd = open((dir_ / "stats").c_str(), O_WRONLY | O_APPEND | O_CREAT,
+                  0644);
+    if (fd < 0)
+        return;
+    // a single-byte append is atomic, whatever the other processes do
+    [[maybe_unused]] auto written = write(fd, &event, 1);
+    close(fd);
+}
@@ -0,0 +1,226 @@
+#include "CompileServer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using std::string;
+using std::operator""s;
+
+namespace {
+
+class CompileServer {
+  public:
+    using compile_fn = int (*)(int argc, char **argv);
+
+    CompileServer(const char *exe_name, unsigned jobs, compile_fn compile)
+        : exe_name_(exe_name), jobs_(jobs), compile_(compile) {}
+
+    int run();
+
+  private:
+    // a request being compiled by a child
+    struct Job {
+        string id;
+        pid_t pid;
+        int fd; // read end of the child's stdout and stderr
+        string partial_line;
+    };
+
+    void read_requests();
+    void start(const string &request);
+    [[noreturn]] void run_child(std::istringstream &args);
+    // forward what the child wrote; false once it is done
+    bool forward(Job &job);
+    void finish(Job &job);
+
+    const char *exe_name_;
+    unsigned jobs_;
+    compile_fn compile_;
+
+    bool eof_{false};
+    string input_;
+    std::deque<string> pending_;
+    std::vector<Job> running_;
+};
+
+int CompileServer::run() {
+    while (not eof_ or not pending_.empty() or not running_.empty()) {
+        while (not pending_.empty() and running_.size() < jobs_) {
+            start(pending_.front());
+            pending_.pop_front();
+        }
+        // flush before polling, so replies reach the client right away and
+        // no child inherits buffered output
+        std::cout.flush();
+
+        std::vector<pollfd> fds;
+        for (auto &job : running_)
+            fds.push_back({job.fd, POLLIN, 0});
+        if (not eof_)
+            fds.push_back({STDIN_FILENO, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cout << exe_name_ << ": poll: " << strerror(errno)
+                      << std::endl;
+            return -1;
+        }
+
+        if (not eof_ and fds.back().revents)
+            read_requests();
+        // fds are in the order of running_, which only shrinks below
+        for (unsigned i = 0, j = 0; i < running_.size(); j++) {
+            if (fds[j].revents and not forward(running_[i])) {
+                finish(running_[i]);
+                running_.erase(running_.begin() + i);
+            } else {
+                i++;
+            }
+        }
+    }
+    std::cout.flush();
+    return 0;
+}
+
+void CompileServer::read_requests() {
+    char buf[4096];
+    auto n = read(STDIN_FILENO, buf, sizeof buf);
+    if (n < 0 and errno == EINTR)
+        return;
+    if (n <= 0) {
+        eof_ = true;
+        // the last request may lack its newline
+        input_ += '\n';
+    } else {
+        input_.append(buf, n);
+    }
+
+    size_t begin = 0, end;
+    while ((end = input_.find('\n', begin)) != string::npos) {
+        auto line = input_.substr(begin, end - begin);
+        if (line.find_first_not_of(" \t\r") != string::npos)
+            pending_.push_back(std::move(line));
+        begin = end + 1;
+    }
+    input_.erase(0, begin);
+}
+
+void CompileServer::start(const string &request) {
+    std::istringstream args(request);
+    Job job;
+    args >> job.id;
+
+    int fds[2];
+    if (pipe(fds) < 0) {
+        std::cout << job.id << " | " << exe_name_
+                  << ": pipe: " << strerror(errno) << "\n"
+                  << job.id << " exit 255\n";
+        return;
+    }
+    std::cout.flush();
+    fflush(stdout);
+    job.pid = fork();
+    if (job.pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        // the requests are for the server, not for the compiler
+        int null = open("/dev/null", O_RDONLY);
+        dup2(null, STDIN_FILENO);
+        close(null);
+        run_child(args);
+    }
+    close(fds[1]);
+    if (job.pid < 0) {
+        close(fds[0]);
+        std::cout << job.id << " | " << exe_name_
+                  << ": fork: " << strerror(errno) << "\n"
+                  << job.id << " exit 255\n";
+        return;
+    }
+    job.fd = fds[0];
+    running_.push_back(std::move(job));
+}
+
+void CompileServer::run_child(std::istringstream &args) {
+    std::vector<string> words;
+    string word;
+    while (args >> word)
+        words.push_back(std::move(word));
+
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(exe_name_));
+    for (auto &w : words)
+        argv.push_back(w.data());
+    argv.push_back(nullptr);
+    // exit() rather than _exit(), to flush the output like a normal run
+    exit(compile_(argv.size() - 1, argv.data()));
+}
+
+bool CompileServer::forward(Job &job) {
+    char buf[4096];
+    auto n = read(job.fd, buf, sizeof buf);
+    if (n < 0 and errno == EINTR)
+        return true;
+    if (n <= 0)
+        return false;
+
+    job.partial_line.append(buf, n);
+    size_t begin = 0, end;
+    while ((end = job.partial_line.find('\n', begin)) != string::npos) {
+        std::cout << job.id << " | "
+                  << std::string_view(job.partial_line)
+                         .substr(begin, end - begin)
+                  << "\n";
+        begin = end + 1;
+    }
+    job.partial_line.erase(0, begin);
+    return true;
+}
+
+void CompileServer::finish(Job &job) {
+    close(job.fd);
+    if (not job.partial_line.empty())
+        std::cout << job.id << " | " << job.partial_line << "\n";
+
+    int status = 0;
+    while (waitpid(job.pid, &status, 0) < 0 and errno == EINTR)
+        ;
+    int code = WIFEXITED(status)     ? WEXITSTATUS(status)
+               : WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+                                     : 255;
+    std::cout << job.id << " exit " << code << "\n";
+}
+
+} // namespace
+
+int serve(int argc, char **argv, int (*compile)(int argc, char **argv)) {
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    // argv[1] is --serve
+    for (int i = 2; i < argc; ++i) {
+        if (argv[i] == "-j"s and i + 1 < argc and atoi(argv[i + 1]) > 0) {
+            jobs = atoi(argv[i + 1]);
+            i += 1;
+        } else {
+            std::cout << argv[0] << ": usage: " << argv[0]
+                      << " --serve [-j <jobs>]" << std::endl;
+            return -1;
+        }
+    }
+    return CompileServer(argv[0], jobs, compile).run();
+}
@@ -1,8 +1,10 @@
 #include "cminusf_builder.hpp"
 
+#include <iostream>
+
 #define CONST_FP(num) ConstantFP::get((float)num, module.get())
 #define CONST_INT(num) ConstantInt::get(num, module.get())
-#define GEN_LABEL() sprintf(labelName, "%08x", context.label++)
+#define GEN_LABEL() gen_label(context.label++)
 
 // Types
 Type *VOID_T;
@@ -11,7 +13,66 @@ Type *INT32_T;
 Type *INT32PTR_T;
 Type *FLOAT_T;
 Type *FLOATPTR_T;
-char labelName[32];
+
+// Name of the n-th basic block, as 8 hex digits
+static std::string gen_label(unsigned n) {
+    static const char digits[] = "0123456789abcdef";
+    std::string label(8, '0');
+    for (int i = 7; i >= 0 and n; i--, n >>= 4)
+        label[i] = digits[n & 0xf];
+    return label;
+}
+
+unsigned Scope::find_slot(std::string_view name, std::size_t hash) const {
+    unsigned mask = slots.size() - 1;
+    for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+        auto &slot = slots[i];
+        if (not slot.used or (slot.hash == hash and slot.name == name))
+            return i;
+    }
+}
+
+void Scope::grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    for (auto &slot : old) {
+        if (not slot.used)
+            continue;
+        auto i = find_slot(slot.name, slot.hash);
+        // every live binding of the name is on its shadow chain
+        for (int b = slot.binding; b >= 0; b = bindings[b].shadowed)
+            bindings[b].slot = i;
+        slots[i] = std::move(slot);
+    }
+}
+
+bool Scope::push(std::string_view name, Value *val) {
+    auto h = hash(name);
+    auto i = find_slot(name, h);
+    if (not slots[i].used) {
+        if (2 * (used_slots + 1) > slots.size()) {
+            grow();
+            i = find_slot(name, h);
+        }
+        slots[i].name = name;
+        slots[i].hash = h;
+        slots[i].used = true;
+        used_slots++;
+    }
+    auto &slot = slots[i];
+    if (slot.binding >= 0 and unsigned(slot.binding) >= scope_begin.back())
+        return false;
+    bindings.push_back({val, i, slot.binding});
+    slot.binding = bindings.size() - 1;
+    return true;
+}
+
+void Scope::exit() {
+    for (auto begin = scope_begin.back(); bindings.size() > begin;
+         bindings.pop_back())
+        slots[bindings.back().slot].binding = bindings.back().shadowed;
+    scope_begin.pop_back();
+}
 
 /*
  * use CMinusfBuilder::Scope to construct scopes
@@ -29,6 +90,9 @@ Value* CminusfBuilder::visit(ASTProgram &node) {
     FLOAT_T = module->get_float_type();
     FLOATPTR_T = module->get_float_ptr_type();
 
+    for (auto &decl : node.declarations) {
+        own_names.insert(decl->id);
+    }
     Value *retVal = nullptr;
     for (auto &decl : node.declarations) {
         retVal = decl->accept(*this);
@@ -45,33 +109,23 @@ Value* CminusfBuilder::visit(ASTNum &node) {
     return nullptr;
 }
 
-Value* CminusfBuilder::visit(ASTVarDeclaration &node) {
-    Type *varType;
+Type *CminusfBuilder::get_var_type(ASTVarDeclaration &node) {
     if (node.num == nullptr) {
         if (node.type == TYPE_INT) {
-            varType = INT32_T;
+            return INT32_T;
         } else {
-            varType = FLOAT_T;
+            return FLOAT_T;
         }
     } else {
         if (node.type == TYPE_INT) {
-            varType = ArrayType::get(INT32_T, node.num->i_val);
+            return ArrayType::get(INT32_T, node.num->i_val);
         } else {
-            varType = ArrayType::get(FLOAT_T, node.num->i_val);
+            return ArrayType::get(FLOAT_T, node.num->i_val);
         }
     }
-    Value *newVar;
-    if (scope.in_global()) { // Is global variable
-        newVar = GlobalVariable::create(node.id, module.get(), varType, false, ConstantZero::get(varType, module.get()));
-    } else {
-        newVar = builder->create_alloca(varType);
-    }
-    scope.push(node.id, newVar);
-    return nullptr;
 }
 
-Value* CminusfBuilder::visit(ASTFunDeclaration &node) {
-    FunctionType *funType;
+FunctionType *CminusfBuilder::get_fun_type(ASTFunDeclaration &node) {
     Type *retType;
     std::vector<Type *> paramTypes;
     if (node.type == TYPE_INT)
@@ -94,13 +148,58 @@ Value* CminusfBuilder::visit(ASTFunDeclaration &node) {
                 paramTypes.push_back(FLOAT_T);
         }
     }
+    return FunctionType::get(retType, paramTypes);
+}
+
+Value *CminusfBuilder::find(std::string_view name) {
+    if (auto val = scope.lookup(name)) {
+        return val;
+    }
+    auto iter = extern_decls.find(name);
+    if (iter != extern_decls.end()) {
+        return iter->second;
+    }
+    // a name used before its definition in this file stays an error
+    if (externals != nullptr && own_names.count(name) == 0) {
+        auto ext = externals->find(name);
+        if (ext != externals->end()) {
+            Value *decl;
+            if (auto fun = dynamic_cast<ASTFunDeclaration *>(ext->second)) {
+                decl = Function::create(get_fun_type(*fun), std::string(name), module.get());
+            } else {
+                auto var = static_cast<ASTVarDeclaration *>(ext->second);
+                auto varType = get_var_type(*var);
+                decl = GlobalVariable::create(std::string(name), module.get(), varType, false, ConstantZero::get(varType, module.get()));
+            }
+            extern_decls[name] = decl;
+            return decl;
+        }
+    }
+    std::cerr << "error: '" << name << "' was not declared";
+    if (context.func != nullptr)
+        std::cerr << " in function '" << context.func->get_name() << "'";
+    std::cerr << std::endl;
+    exit(1);
+}
 
-    funType = FunctionType::get(retType, paramTypes);
-    auto func = Function::create(funType, node.id, module.get());
+Value* CminusfBuilder::visit(ASTVarDeclaration &node) {
+    Type *varType = get_var_type(node);
+    Value *newVar;
+    if (scope.in_global()) { // Is global variable
+        newVar = GlobalVariable::create(std::string(node.id), module.get(), varType, false, ConstantZero::get(varType, module.get()));
+    } else {
+        newVar = builder->create_alloca(varType);
+    }
+    scope.push(node.id, newVar);
+    return nullptr;
+}
+
+Value* CminusfBuilder::visit(ASTFunDeclaration &node) {
+    FunctionType *funType = get_fun_type(node);
+    auto func = Function::create(funType, std::string(node.id), module.get());
     scope.push(node.id, func);
     context.func = func;
-    GEN_LABEL();
-    auto funBB = BasicBlock::create(module.get(), labelName, func);
+    auto funBB = BasicBlock::create(module.get(), GEN_LABEL(), func);
     builder->set_insert_point(funBB);
     scope.enter();
     std::vector<Value *> args;
@@ -167,12 +266,9 @@ Value* CminusfBuilder::visit(ASTExpressionStmt &node) {
 
 Value* CminusfBuilder::visit(ASTSelectionStmt &node) {
     // Create basic blocks
-    GEN_LABEL();
-    auto trueBB = BasicBlock::create(module.get(), labelName, context.func);
-    GEN_LABEL();
-    auto falseBB = BasicBlock::create(module.get(), labelName, context.func);
-    GEN_LABEL();
-    auto endBB = BasicBlock::create(module.get(), labelName, context.func);
+    auto trueBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+    auto falseBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+    auto endBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
     node.expression->accept(*this);
     // Create comparison to zero
     if (context.value->get_type()->is_integer_type()) {
@@ -206,12 +302,12 @@ Value* CminusfBuilder::visit(ASTSelectionStmt &node) {
 }
 
 Value* CminusfBuilder::visit(ASTIterationStmt &node) {
-    GEN_LABEL(); // Condition
-    auto condBB = BasicBlock::create(module.get(), labelName, context.func);
-    GEN_LABEL(); // Iteration body
-    auto bodyBB = BasicBlock::create(module.get(), labelName, context.func);
-    GEN_LABEL(); // End
-    auto endBB = BasicBlock::create(module.get(), labelName, context.func);
+    // Condition
+    auto condBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+    // Iteration body
+    auto bodyBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+    // End
+    auto endBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
 
     if (!builder->get_insert_block()->is_terminated()) {
         builder->create_br(condBB);
@@ -257,7 +353,7 @@ Value* CminusfBuilder::visit(ASTReturnStmt &node) {
 }
 
 Value* CminusfBuilder::visit(ASTVar &node) {
-    context.value = scope.find(node.id);
+    context.value = find(node.id);
     if (node.expression == nullptr) {
         if (context.lvalue == 0) {
             if (context.value->get_type()->get_pointer_element_type()->is_array_type()) {
@@ -276,12 +372,9 @@ Value* CminusfBuilder::visit(ASTVar &node) {
         if (rVal->get_type()->is_float_type()) {
             rVal = builder->create_fptosi(rVal, INT32_T);
         }
-        GEN_LABEL();
-        auto trueBB = BasicBlock::create(module.get(), labelName, context.func);
-        GEN_LABEL();
-        auto falseBB = BasicBlock::create(module.get(), labelName, context.func);
-        GEN_LABEL();
-        auto endBB = BasicBlock::create(module.get(), labelName, context.func);
+        auto trueBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+        auto falseBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
+        auto endBB = BasicBlock::create(module.get(), GEN_LABEL(), context.func);
         auto *cond = builder->create_icmp_ge(rVal, CONST_INT(0));
         builder->create_cond_br(cond, trueBB, falseBB);
         // True
@@ -445,7 +538,7 @@ Value* CminusfBuilder::visit(ASTTerm &node) {
 }
 
 Value* CminusfBuilder::visit(ASTCall &node) {
-    auto *func = (Function *)(scope.find(node.id));
+    auto *func = (Function *)(find(node.id));
     auto param = func->get_function_type()->param_begin();
     std::vector<Value *> args;
     for (auto &arg : node.args) {
@@ -1,5 +1,9 @@
+#include "Bitcode.hpp"
 #include "CodeGen.hpp"
+#include "CompileCache.hpp"
+#include "CompileServer.hpp"
 #include "DeadCode.hpp"
+#include "Linker.hpp"
 #include "Mem2Reg.hpp"
 #include "Module.hpp"
 #include "PassManager.hpp"
@@ -7,26 +11,39 @@
 
 #include <filesystem>
 #include <fstream>
+#include <llvm/Support/raw_ostream.h>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using std::string;
 using std::operator""s;
 
 struct Config {
     string exe_name; // compiler exe name
-    std::filesystem::path input_file;
+    // all of them are linked into one program
+    std::vector<std::filesystem::path> input_files;
     std::filesystem::path output_file;
 
     bool emitllvm{false};
     bool emitasm{false};
+    bool emitbc{false};
+    bool emitobj{false};
     bool mem2reg{false};
+    bool fast_lexer{false};
+    // reuse outputs of earlier compilations when not empty
+    std::filesystem::path cache_dir;
+    bool cache_stats{false};
 
     Config(int argc, char **argv) : argc(argc), argv(argv) {
         parse_cmd_line();
         check();
     }
 
+    // print error message and exit
+    void print_err(const string &msg) const;
+
   private:
     int argc{-1};
     char **argv{nullptr};
@@ -35,19 +52,100 @@ struct Config {
     void check();
     // print helper infomation and exit
     void print_help() const;
-    void print_err(const string &msg) const;
 };
 
-int main(int argc, char **argv) {
+// Key the cache on the inputs and on every option that changes the output.
+static std::unique_ptr<CompileCache> open_cache(const Config &config) {
+    auto cache = std::make_unique<CompileCache>(config.cache_dir);
+    cache->add(config.emitllvm  ? "-emit-llvm"
+               : config.emitasm ? "-S"
+               : config.emitbc  ? "-emit-bc"
+                                : "-c");
+    // the pass pipeline built in main()
+    cache->add(config.mem2reg ? "Mem2Reg,DeadCode" : "");
+    if (config.emitllvm) {
+        // printed as source_filename
+        std::error_code ec;
+        cache->add(std::filesystem::canonical(config.input_files.front(), ec)
+                       .string());
+    }
+    for (auto &input : config.input_files)
+        if (not cache->add_file(input))
+            return nullptr; // let the compiler report it
+    return cache;
+}
+
+static void print_cache_stats(const Config &config) {
+    auto stats = CompileCache(config.cache_dir).get_stats();
+    std::cout << "cache hits: " << stats.hits << "\n"
+              << "cache misses: " << stats.misses << std::endl;
+}
+
+// One run of the compiler, also used by each request of --serve.
+static int compile(int argc, char **argv) {
     Config config(argc, argv);
 
-    std::unique_ptr<Module> m;
-    {
-        auto syntax_tree = parse(config.input_file.c_str());
-        auto ast = AST(syntax_tree);
-        CminusfBuilder builder;
-        ast.run_visitor(builder);
-        m = builder.getModule();
+    if (config.input_files.empty()) {
+        // only asked for the statistics
+        print_cache_stats(config);
+        return 0;
+    }
+
+    std::unique_ptr<CompileCache> cache;
+    if (not config.cache_dir.empty() and config.output_file != "-")
+        cache = open_cache(config);
+    if (cache and cache->fetch(config.output_file)) {
+        if (config.cache_stats)
+            print_cache_stats(config);
+        return 0;
+    }
+
+    // parse every source first, so that each file can refer to the
+    // functions and globals defined in the others
+    std::vector<AST> asts;
+    CminusfBuilder::Externals externals;
+    for (auto &input : config.input_files) {
+        if (input.extension() == BITCODE_EXTENSION)
+            continue;
+        asts.push_back(parse_ast(input.c_str(), config.fast_lexer));
+        for (auto &decl : asts.back().get_root()->declarations) {
+            auto [it, inserted] = externals.emplace(decl->id, decl);
+            // the builder would declare one as the other, the linker
+            // reports the rest of the conflicts
+            if (not inserted and
+                (dynamic_cast<ASTFunDeclaration *>(it->second) == nullptr) !=
+                    (dynamic_cast<ASTFunDeclaration *>(decl) == nullptr))
+                config.print_err(input.string() + ": '" +
+                                 std::string(decl->id) +
+                                 "' is both a function and a variable");
+        }
+    }
+
+    // one module per file
+    std::vector<std::unique_ptr<Module>> modules;
+    auto ast = asts.begin();
+    for (auto &input : config.input_files) {
+        if (input.extension() == BITCODE_EXTENSION) {
+            // a module saved by -emit-bc, no need to run the frontend again
+            string err;
+            modules.push_back(read_bitcode(input.string(), err));
+            if (not modules.back())
+                config.print_err(err);
+        } else {
+            CminusfBuilder builder;
+            builder.set_externals(&externals);
+            (ast++)->run_visitor(builder);
+            modules.push_back(builder.getModule());
+        }
+    }
+
+    // link the whole program into the first module
+    auto m = std::move(modules.front());
+    for (unsigned i = 1; i < modules.size(); i++) {
+        string err;
+        if (not link_modules(m.get(), modules[i].get(), err))
+            config.print_err(config.input_files[i].string() + ": " + err);
+        modules[i].reset();
     }
 
     PassManager PM(m.get());
@@ -58,21 +156,50 @@ int main(int argc, char **argv) {
     }
     PM.run();
 
-    std::ofstream output_stream(config.output_file);
+    std::error_code ec;
+    llvm::raw_fd_ostream output_stream(config.output_file.string(), ec);
+    if (ec)
+        config.print_err(config.output_file.string() + ": " + ec.message());
+    // write through one large buffer instead of building the whole text
+    output_stream.SetBufferSize(1 << 20);
     if (config.emitllvm) {
-        auto abs_path = std::filesystem::canonical(config.input_file);
+        auto abs_path =
+            std::filesystem::canonical(config.input_files.front());
+        // keep the quoting of std::filesystem::path
+        std::ostringstream source_filename;
+        source_filename << abs_path;
         output_stream << "; ModuleID = 'cminus'\n";
-        output_stream << "source_filename = " << abs_path << "\n\n";
-        output_stream << m->print();
-    } else if (config.emitasm) {
+        output_stream << "source_filename = " << source_filename.str()
+                      << "\n\n";
+        m->print(output_stream);
+    } else if (config.emitasm or config.emitobj) {
         CodeGen codegen(m.get());
         codegen.run();
-        output_stream << codegen.print();
+        string err;
+        if (config.emitasm)
+            codegen.print(output_stream);
+        else if (not codegen.emit_object(output_stream, err))
+            config.print_err(err);
+    } else if (config.emitbc) {
+        write_bitcode(m.get(), output_stream);
     }
 
+    if (cache) {
+        output_stream.close();
+        if (not output_stream.has_error())
+            cache->store(config.output_file);
+    }
+    if (config.cache_stats)
+        print_cache_stats(config);
     return 0;
 }
 
+int main(int argc, char **argv) {
+    if (argc > 1 and argv[1] == "--serve"s)
+        return serve(argc, argv, compile);
+    return compile(argc, argv);
+}
+
 void Config::parse_cmd_line() {
     exe_name = argv[0];
     for (int i = 1; i < argc; ++i) {
@@ -87,50 +214,82 @@ void Config::parse_cmd_line() {
             }
         } else if (argv[i] == "-emit-llvm"s) {
             emitllvm = true;
+        } else if (argv[i] == "-emit-bc"s) {
+            emitbc = true;
         } else if (argv[i] == "-S"s) {
             emitasm = true;
+        } else if (argv[i] == "-c"s) {
+            emitobj = true;
         } else if (argv[i] == "-mem2reg"s) {
             mem2reg = true;
-        } else {
-            if (input_file.empty()) {
-                input_file = argv[i];
+        } else if (argv[i] == "-fast-lexer"s) {
+            fast_lexer = true;
+        } else if (argv[i] == "-cache-dir"s) {
+            if (cache_dir.empty() && i + 1 < argc) {
+                cache_dir = argv[i + 1];
+                i += 1;
             } else {
-                string err =
-                    "unrecognized command-line option \'"s + argv[i] + "\'"s;
-                print_err(err);
+                print_err("bad cache directory");
             }
+        } else if (argv[i] == "-cache-stats"s) {
+            cache_stats = true;
+        } else if (argv[i][0] == '-' and argv[i][1] != '\0') {
+            string err =
+                "unrecognized command-line option \'"s + argv[i] + "\'"s;
+            print_err(err);
+        } else {
+            input_files.push_back(argv[i]);
         }
     }
 }
 
 void Config::check() {
-    if (input_file.empty()) {
+    if (cache_stats and cache_dir.empty()) {
+        print_err("-cache-stats requires -cache-dir");
+    }
+    if (input_files.empty()) {
+        if (cache_stats)
+            return;
         print_err("no input file");
     }
-    if (input_file.extension() != ".cminus") {
-        print_err("file format not recognized");
+    for (auto &input_file : input_files) {
+        if (input_file.extension() != ".cminus" and
+            input_file.extension() != BITCODE_EXTENSION) {
+            print_err(input_file.string() + ": file format not recognized");
+        }
     }
     if (emitllvm and emitasm) {
         print_err("emit llvm and emit asm both set");
     }
-    if (not emitllvm and not emitasm) {
+    if (emitbc and (emitllvm or emitasm)) {
+        print_err("emit bitcode and emit llvm/asm both set");
+    }
+    if (emitobj and (emitllvm or emitasm or emitbc)) {
+        print_err("emit object and emit llvm/asm/bitcode both set");
+    }
+    if (not emitllvm and not emitasm and not emitbc and not emitobj) {
         print_err("not supported: generate executable file directly");
     }
     if (output_file.empty()) {
-        output_file = input_file.stem();
+        output_file = input_files.front().stem();
         if (emitllvm) {
             output_file.replace_extension(".ll");
         } else if (emitasm) {
             output_file.replace_extension(".s");
+        } else if (emitbc) {
+            output_file.replace_extension(BITCODE_EXTENSION);
+        } else if (emitobj) {
+            output_file.replace_extension(".o");
         }
     }
 }
 
 void Config::print_help() const {
     std::cout << "Usage: " << exe_name
-              << " [-h|--help] [-o <target-file>] [-mem2reg] [-emit-llvm] [-S] "
-                 "<input-file>"
-              << std::endl;
+              << " [-h|--help] [-o <target-file>] [-mem2reg] [-fast-lexer] "
+                 "[-cache-dir <dir>] [-cache-stats] [-emit-llvm] [-emit-bc] "
+                 "[-S] [-c] <input-file>...\n"
+              << "       " << exe_name << " --serve [-j <jobs>]" << std::endl;
     exit(0);
 }
 
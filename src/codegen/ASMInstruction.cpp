@@ -0,0 +1,287 @@
+#include "ASMInstruction.hpp"
+#include "Instruction.hpp"
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace {
+
+/* 机器码的编码格式, 字段位置见《龙芯架构参考手册》卷一
+ * 寄存器字段记为 rd (0-4 位), rj (5-9 位), rk (10-14 位)
+ */
+enum Encoding : uint8_t {
+    NONE,  // 伪指令, 标签和注释
+    R3,    // rd, rj, rk
+    R2,    // rd, rj
+    RI12,  // rd, rj, si12/ui12
+    RI20,  // rd, si20
+    LU52I, // rd, si12, 其中 rj 与 rd 相同
+    BSTR,  // rd, rj, msb, lsb
+    FCMP,  // cd, fj, fk
+    I26,   // offs26
+    RI21,  // rj, offs21
+    JR,    // jirl $zero, rj, 0
+    LA,    // pcalau12i + addi.d
+};
+
+/* 助记符, 操作数格式与编码
+ * 格式中 %r, %i, %s 依次取下一个寄存器, 立即数和符号, 其余字符原样输出
+ */
+struct OpInfo {
+    const char *name;
+    const char *format;
+    uint32_t opcode; // 各操作数字段为 0 时的机器码
+    Encoding encoding;
+};
+
+constexpr uint32_t PCALAU12I = 0x1a000000;
+
+const OpInfo op_info[] = {
+    // Arithmetic
+    {"add.w", "%r, %r, %r", 0x00100000, R3},
+    {"add.d", "%r, %r, %r", 0x00108000, R3},
+    {"sub.w", "%r, %r, %r", 0x00110000, R3},
+    {"sub.d", "%r, %r, %r", 0x00118000, R3},
+    {"mul.w", "%r, %r, %r", 0x001c0000, R3},
+    {"div.w", "%r, %r, %r", 0x00200000, R3},
+    {"addi.w", "%r, %r, %i", 0x02800000, RI12},
+    {"addi.d", "%r, %r, %i", 0x02c00000, RI12},
+    {"lu12i.w", "%r, %i", 0x14000000, RI20},
+    {"lu32i.d", "%r, %i", 0x16000000, RI20},
+    {"lu52i.d", "%r, %i", 0x03000000, LU52I},
+    // Logic
+    {"slt", "%r, %r, %r", 0x00120000, R3},
+    {"or", "%r, %r, %r", 0x00150000, R3},
+    {"nor", "%r, %r, %r", 0x00140000, R3},
+    {"ori", "%r, %r, %i", 0x03800000, RI12},
+    {"bstrpick.w", "%r, %r, %i, %i", 0x00608000, BSTR},
+    {"bstrpick.d", "%r, %r, %i, %i", 0x00c00000, BSTR},
+    // Memory access
+    {"ld.b", "%r, %r, %i", 0x28000000, RI12},
+    {"ld.w", "%r, %r, %i", 0x28800000, RI12},
+    {"ld.d", "%r, %r, %i", 0x28c00000, RI12},
+    {"st.b", "%r, %r, %i", 0x29000000, RI12},
+    {"st.w", "%r, %r, %i", 0x29800000, RI12},
+    {"st.d", "%r, %r, %i", 0x29c00000, RI12},
+    {"fld.s", "%r, %r, %i", 0x2b000000, RI12},
+    {"fst.s", "%r, %r, %i", 0x2b400000, RI12},
+    // Float
+    {"fadd.s", "%r, %r, %r", 0x01008000, R3},
+    {"fsub.s", "%r, %r, %r", 0x01028000, R3},
+    {"fmul.s", "%r, %r, %r", 0x01048000, R3},
+    {"fdiv.s", "%r, %r, %r", 0x01068000, R3},
+    {"fcmp.slt.s", "%r, %r, %r", 0x0c118000, FCMP},
+    {"fcmp.sle.s", "%r, %r, %r", 0x0c138000, FCMP},
+    {"fcmp.seq.s", "%r, %r, %r", 0x0c128000, FCMP},
+    {"fcmp.sne.s", "%r, %r, %r", 0x0c188000, FCMP},
+    {"ffint.s.w", "%r, %r", 0x011d1000, R2},
+    {"ftintrz.w.s", "%r, %r", 0x011a8400, R2},
+    // Data transfer (greg <-> freg)
+    {"movgr2fr.w", "%r, %r", 0x0114a400, R2},
+    {"movfr2gr.s", "%r, %r", 0x0114b400, R2},
+    // Branch
+    {"b", "%s", 0x50000000, I26},
+    {"bl", "%s", 0x54000000, I26},
+    {"bnez", "%r, %s", 0x44000000, RI21},
+    {"jr", "%r", 0x4c000000, JR},
+    // ASM syntax sugar
+    {"la.local", "%r, %s", 0, LA},
+    // 伪指令
+    {".text", "", 0, NONE},
+    {".section", ".bss, \"aw\", @nobits", 0, NONE},
+    {".globl", "%s", 0, NONE},
+    {".type", "%s, @object", 0, NONE},
+    {".type", "%s, @function", 0, NONE},
+    {".size", "%s, %i", 0, NONE},
+    {".space", "%i", 0, NONE},
+    // 以下由 print 单独处理
+    {"", "%s", 0, NONE},
+    {"", "%s", 0, NONE},
+    {"", "", 0, NONE},
+    {"", "%s", 0, NONE},
+};
+static_assert(sizeof(op_info) / sizeof(op_info[0]) ==
+                  static_cast<unsigned>(ASMOp::RAW) + 1,
+              "op_info does not match ASMOp");
+
+const OpInfo &get_op_info(ASMOp op) {
+    return op_info[static_cast<unsigned>(op)];
+}
+
+// 寄存器在指令中的字段值, 条件标志寄存器只有 0-7
+uint32_t reg_field(uint8_t reg) { return reg & 0x1f; }
+
+void print_reg(llvm::raw_ostream &os, uint8_t reg) {
+    if (reg < ASMInstruction::FREG_BASE)
+        os << Reg(reg).print();
+    else if (reg < ASMInstruction::CFREG_BASE)
+        os << FReg(reg - ASMInstruction::FREG_BASE).print();
+    else
+        os << CFReg(reg - ASMInstruction::CFREG_BASE).print();
+}
+
+} // namespace
+
+ASMInstruction::ASMInstruction(ASMOp op,
+                               std::initializer_list<ASMOperand> operands)
+    : op(op), regs(), imms(), symbol(nullptr) {
+    unsigned num_regs = 0, num_imms = 0, num_syms = 0;
+    for (auto &operand : operands) {
+        switch (operand.kind) {
+        case ASMOperand::Register:
+            assert(num_regs < MAX_REGS && "too many registers");
+            regs[num_regs++] = operand.reg;
+            break;
+        case ASMOperand::Immediate:
+            assert(num_imms < MAX_IMMS && "too many immediates");
+            imms[num_imms++] = operand.imm;
+            break;
+        case ASMOperand::Symbol:
+            assert(num_syms == 0 && "too many symbols");
+            num_syms++;
+            symbol = operand.symbol;
+            break;
+        }
+    }
+#ifndef NDEBUG
+    // 操作数需与格式一一对应
+    for (auto fmt = get_op_info(op).format; *fmt; fmt++) {
+        if (*fmt != '%')
+            continue;
+        switch (*++fmt) {
+        case 'r':
+            num_regs--;
+            break;
+        case 'i':
+            num_imms--;
+            break;
+        case 's':
+            num_syms--;
+            break;
+        }
+    }
+    assert(num_regs == 0 && num_imms == 0 && num_syms == 0 &&
+           "operands do not match the instruction format");
+#endif
+}
+
+void ASMInstruction::print(llvm::raw_ostream &os) const {
+    switch (op) {
+    case ASMOp::LABEL:
+        os << *symbol << ":\n";
+        return;
+    case ASMOp::COMMENT:
+        os << "# " << *symbol << '\n';
+        return;
+    case ASMOp::IR_COMMENT:
+        os << "# ";
+        ir->print(os);
+        os << '\n';
+        return;
+    case ASMOp::RAW:
+        os << '\t' << *symbol << '\n';
+        return;
+    default:
+        break;
+    }
+
+    auto &info = get_op_info(op);
+    os << '\t' << info.name;
+    if (*info.format)
+        os << ' ';
+    unsigned reg_idx = 0, imm_idx = 0;
+    for (auto fmt = info.format; *fmt; fmt++) {
+        if (*fmt != '%') {
+            os << *fmt;
+            continue;
+        }
+        switch (*++fmt) {
+        case 'r':
+            print_reg(os, regs[reg_idx++]);
+            break;
+        case 'i':
+            os << imms[imm_idx++];
+            break;
+        case 's':
+            os << *symbol;
+            break;
+        }
+    }
+    os << '\n';
+}
+
+std::string ASMInstruction::format() const {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    print(os);
+    os.flush();
+    return str;
+}
+
+unsigned ASMInstruction::get_size() const {
+    switch (get_op_info(op).encoding) {
+    case NONE:
+        return 0;
+    case LA:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+unsigned ASMInstruction::encode(uint32_t code[2], int32_t offset) const {
+    auto &info = get_op_info(op);
+    uint32_t rd = reg_field(regs[0]), rj = reg_field(regs[1]),
+             rk = reg_field(regs[2]);
+    switch (info.encoding) {
+    case NONE:
+        return 0;
+    case R3:
+        code[0] = info.opcode | rk << 10 | rj << 5 | rd;
+        return 1;
+    case R2:
+        code[0] = info.opcode | rj << 5 | rd;
+        return 1;
+    case RI12:
+        code[0] = info.opcode | (imms[0] & 0xfff) << 10 | rj << 5 | rd;
+        return 1;
+    case RI20:
+        code[0] = info.opcode | (imms[0] & 0xfffff) << 5 | rd;
+        return 1;
+    case LU52I:
+        code[0] = info.opcode | (imms[0] & 0xfff) << 10 | rd << 5 | rd;
+        return 1;
+    case BSTR:
+        assert(imms[0] >= imms[1] && "bad bit field");
+        code[0] = info.opcode | imms[0] << 16 | imms[1] << 10 | rj << 5 | rd;
+        return 1;
+    case FCMP:
+        code[0] = info.opcode | rk << 10 | rj << 5 | (rd & 0x7);
+        return 1;
+    case I26: {
+        assert(offset % 4 == 0 && "misaligned branch");
+        auto offs = static_cast<uint32_t>(offset >> 2);
+        assert((offset >> 2) >= -(1 << 25) && (offset >> 2) < (1 << 25) &&
+               "branch out of range");
+        code[0] = info.opcode | (offs & 0xffff) << 10 | (offs >> 16 & 0x3ff);
+        return 1;
+    }
+    case RI21: {
+        assert(offset % 4 == 0 && "misaligned branch");
+        auto offs = static_cast<uint32_t>(offset >> 2);
+        assert((offset >> 2) >= -(1 << 20) && (offset >> 2) < (1 << 20) &&
+               "branch out of range");
+        code[0] = info.opcode | (offs & 0xffff) << 10 | rd << 5 |
+                  (offs >> 16 & 0x1f);
+        return 1;
+    }
+    case JR:
+        code[0] = info.opcode | rd << 5;
+        return 1;
+    case LA:
+        // 地址的高 20 位和低 12 位都由重定位填写
+        code[0] = PCALAU12I | rd;
+        code[1] = get_op_info(ASMOp::ADDI_D).opcode | rd << 5 | rd;
+        return 2;
+    }
+    return 0;
+}
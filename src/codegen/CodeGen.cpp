@@ -1,6 +1,9 @@
 #include "CodeGen.hpp"
 
 #include "CodeGenUtil.hpp"
+#include "ObjectWriter.hpp"
+
+#include <llvm/Support/raw_ostream.h>
 
 void CodeGen::allocate() {
     // 备份 $ra $fp
@@ -39,15 +42,15 @@ void CodeGen::load_to_greg(Value* val, const Reg& reg) {
     assert(val->get_type()->is_integer_type() ||
            val->get_type()->is_pointer_type());
 
-    if (auto* constant = dynamic_cast<ConstantInt*>(val)) {
+    if (auto* constant = dyn_cast<ConstantInt>(val)) {
         int32_t val = constant->get_value();
         if (IS_IMM_12(val)) {
-            append_inst(ADDI WORD, {reg.print(), "$zero", std::to_string(val)});
+            append_inst(ASMOp::ADDI_W, {reg, Reg::zero(), val});
         } else {
             load_large_int32(val, reg);
         }
-    } else if (auto* global = dynamic_cast<GlobalVariable*>(val)) {
-        append_inst(LOAD_ADDR, {reg.print(), global->get_name()});
+    } else if (auto* global = dyn_cast<GlobalVariable>(val)) {
+        append_inst(ASMOp::LA_LOCAL, {reg, &global->get_name()});
     } else {
         load_from_stack_to_greg(val, reg);
     }
@@ -56,8 +59,8 @@ void CodeGen::load_to_greg(Value* val, const Reg& reg) {
 void CodeGen::load_large_int32(int32_t val, const Reg& reg) {
     int32_t high_20 = val >> 12;  // si20
     uint32_t low_12 = val & LOW_12_MASK;
-    append_inst(LU12I_W, {reg.print(), std::to_string(high_20)});
-    append_inst(ORI, {reg.print(), reg.print(), std::to_string(low_12)});
+    append_inst(ASMOp::LU12I_W, {reg, high_20});
+    append_inst(ASMOp::ORI, {reg, reg, low_12});
 }
 
 void CodeGen::load_large_int64(int64_t val, const Reg& reg) {
@@ -67,76 +70,65 @@ void CodeGen::load_large_int64(int64_t val, const Reg& reg) {
     auto high_32 = static_cast<int32_t>(val >> 32);
     int32_t high_32_low_20 = (high_32 << 12) >> 12;  // si20
     int32_t high_32_high_12 = high_32 >> 20;         // si12
-    append_inst(LU32I_D, {reg.print(), std::to_string(high_32_low_20)});
-    append_inst(LU52I_D, {reg.print(), std::to_string(high_32_high_12)});
+    append_inst(ASMOp::LU32I_D, {reg, high_32_low_20});
+    append_inst(ASMOp::LU52I_D, {reg, high_32_high_12});
 }
 
 void CodeGen::load_from_stack_to_greg(Value* val, const Reg& reg) {
     auto offset = context.offset_map.at(val);
-    auto offset_str = std::to_string(offset);
     auto* type = val->get_type();
+    ASMOp op;
+    if (type->is_int1_type()) {
+        op = ASMOp::LD_B;
+    } else if (type->is_int32_type()) {
+        op = ASMOp::LD_W;
+    } else {  // Pointer
+        op = ASMOp::LD_D;
+    }
     if (IS_IMM_12(offset)) {
-        if (type->is_int1_type()) {
-            append_inst(LOAD BYTE, {reg.print(), "$fp", offset_str});
-        } else if (type->is_int32_type()) {
-            append_inst(LOAD WORD, {reg.print(), "$fp", offset_str});
-        } else {  // Pointer
-            append_inst(LOAD DOUBLE, {reg.print(), "$fp", offset_str});
-        }
+        append_inst(op, {reg, Reg::fp(), offset});
     } else {
         load_large_int64(offset, reg);
-        append_inst(ADD DOUBLE, {reg.print(), "$fp", reg.print()});
-        if (type->is_int1_type()) {
-            append_inst(LOAD BYTE, {reg.print(), reg.print(), "0"});
-        } else if (type->is_int32_type()) {
-            append_inst(LOAD WORD, {reg.print(), reg.print(), "0"});
-        } else {  // Pointer
-            append_inst(LOAD DOUBLE, {reg.print(), reg.print(), "0"});
-        }
+        append_inst(ASMOp::ADD_D, {reg, Reg::fp(), reg});
+        append_inst(op, {reg, reg, 0});
     }
 }
 
 void CodeGen::store_from_greg(Value* val, const Reg& reg) {
     auto offset = context.offset_map.at(val);
-    auto offset_str = std::to_string(offset);
     auto* type = val->get_type();
+    ASMOp op;
+    if (type->is_int1_type()) {
+        op = ASMOp::ST_B;
+    } else if (type->is_int32_type()) {
+        op = ASMOp::ST_W;
+    } else {  // Pointer
+        op = ASMOp::ST_D;
+    }
     if (IS_IMM_12(offset)) {
-        if (type->is_int1_type()) {
-            append_inst(STORE BYTE, {reg.print(), "$fp", offset_str});
-        } else if (type->is_int32_type()) {
-            append_inst(STORE WORD, {reg.print(), "$fp", offset_str});
-        } else {  // Pointer
-            append_inst(STORE DOUBLE, {reg.print(), "$fp", offset_str});
-        }
+        append_inst(op, {reg, Reg::fp(), offset});
     } else {
         auto addr = Reg::t(8);
         load_large_int64(offset, addr);
-        append_inst(ADD DOUBLE, {addr.print(), "$fp", addr.print()});
-        if (type->is_int1_type()) {
-            append_inst(STORE BYTE, {reg.print(), addr.print(), "0"});
-        } else if (type->is_int32_type()) {
-            append_inst(STORE WORD, {reg.print(), addr.print(), "0"});
-        } else {  // Pointer
-            append_inst(STORE DOUBLE, {reg.print(), addr.print(), "0"});
-        }
+        append_inst(ASMOp::ADD_D, {addr, Reg::fp(), addr});
+        append_inst(op, {reg, addr, 0});
     }
 }
 
 void CodeGen::load_to_freg(Value* val, const FReg& freg) {
     assert(val->get_type()->is_float_type());
-    if (auto* constant = dynamic_cast<ConstantFP*>(val)) {
+    if (auto* constant = dyn_cast<ConstantFP>(val)) {
         float val = constant->get_value();
         load_float_imm(val, freg);
     } else {
         auto offset = context.offset_map.at(val);
-        auto offset_str = std::to_string(offset);
         if (IS_IMM_12(offset)) {
-            append_inst(FLOAD SINGLE, {freg.print(), "$fp", offset_str});
+            append_inst(ASMOp::FLD_S, {freg, Reg::fp(), offset});
         } else {
             auto addr = Reg::t(8);
             load_large_int64(offset, addr);
-            append_inst(ADD DOUBLE, {addr.print(), "$fp", addr.print()});
-            append_inst(FLOAD SINGLE, {freg.print(), addr.print(), "0"});
+            append_inst(ASMOp::ADD_D, {addr, Reg::fp(), addr});
+            append_inst(ASMOp::FLD_S, {freg, addr, 0});
         }
     }
 }
@@ -144,33 +136,32 @@ void CodeGen::load_to_freg(Value* val, const FReg& freg) {
 void CodeGen::load_float_imm(float val, const FReg& r) {
     int32_t bytes = *reinterpret_cast<int32_t*>(&val);
     load_large_int32(bytes, Reg::t(8));
-    append_inst(GR2FR WORD, {r.print(), Reg::t(8).print()});
+    append_inst(ASMOp::MOVGR2FR_W, {r, Reg::t(8)});
 }
 
 void CodeGen::store_from_freg(Value* val, const FReg& r) {
     auto offset = context.offset_map.at(val);
     if (IS_IMM_12(offset)) {
-        auto offset_str = std::to_string(offset);
-        append_inst(FSTORE SINGLE, {r.print(), "$fp", offset_str});
+        append_inst(ASMOp::FST_S, {r, Reg::fp(), offset});
     } else {
         auto addr = Reg::t(8);
         load_large_int64(offset, addr);
-        append_inst(ADD DOUBLE, {addr.print(), "$fp", addr.print()});
-        append_inst(FSTORE SINGLE, {r.print(), addr.print(), "0"});
+        append_inst(ASMOp::ADD_D, {addr, Reg::fp(), addr});
+        append_inst(ASMOp::FST_S, {r, addr, 0});
     }
 }
 
 void CodeGen::gen_prologue() {
     // 寄存器备份及栈帧设置
-    append_inst("st.d $ra, $sp, -8");  // Enhance
-    append_inst("st.d $fp, $sp, -16");
-    append_inst("addi.d $fp, $sp, 0");
+    append_inst(ASMOp::ST_D, {Reg::ra(), Reg::sp(), -8});  // Enhance
+    append_inst(ASMOp::ST_D, {Reg::fp(), Reg::sp(), -16});
+    append_inst(ASMOp::ADDI_D, {Reg::fp(), Reg::sp(), 0});
     if (IS_IMM_12(-static_cast<int>(context.frame_size))) {
-        append_inst("addi.d $sp, $sp, " +
-                    std::to_string(-static_cast<int>(context.frame_size)));
+        append_inst(ASMOp::ADDI_D, {Reg::sp(), Reg::sp(),
+                                    -static_cast<int>(context.frame_size)});
     } else {
         load_large_int64(context.frame_size, Reg::t(0));
-        append_inst("sub.d $sp, $sp, $t0");
+        append_inst(ASMOp::SUB_D, {Reg::sp(), Reg::sp(), Reg::t(0)});
     }
 
     // 将函数参数转移到栈帧上
@@ -187,32 +178,30 @@ void CodeGen::gen_prologue() {
 
 void CodeGen::gen_epilogue() {
     // DONE: 根据你的理解设定函数的 epilogue
-    auto exit_label = context.func->get_name() + "_exit";  // Enhance
-    append_inst(exit_label, ASMInstruction::Label);
+    append_inst(ASMOp::LABEL, {context.exit_label});
     if (IS_IMM_12(static_cast<int>(context.frame_size))) {
-        append_inst("addi.d $sp, $sp, " +
-                    std::to_string(static_cast<int>(context.frame_size)));
+        append_inst(ASMOp::ADDI_D, {Reg::sp(), Reg::sp(),
+                                    static_cast<int>(context.frame_size)});
     } else {
         load_large_int64(context.frame_size, Reg::t(0));
-        append_inst("add.d $sp, $sp, $t0");
+        append_inst(ASMOp::ADD_D, {Reg::sp(), Reg::sp(), Reg::t(0)});
     }
-    append_inst("ld.d $ra, $sp, -8");
-    append_inst("ld.d $fp, $sp, -16");
-    append_inst("jr $ra");
+    append_inst(ASMOp::LD_D, {Reg::ra(), Reg::sp(), -8});
+    append_inst(ASMOp::LD_D, {Reg::fp(), Reg::sp(), -16});
+    append_inst(ASMOp::JR, {Reg::ra()});
 }
 
 void CodeGen::gen_ret() {
     // DONE: 函数返回，思考如何处理返回值、寄存器备份，如何返回调用者地址
     auto* retInst = static_cast<ReturnInst*>(context.inst);
     if (retInst->is_void_ret()) {
-        append_inst("addi.d $a0, $zero, 0");  // Clear $a0
+        append_inst(ASMOp::ADDI_D, {Reg::a(0), Reg::zero(), 0});  // Clear $a0
     } else if (retInst->get_operand(0)->get_type()->is_float_type()) {
         load_to_freg(retInst->get_operand(0), FReg::fa(0));
     } else {
         load_to_greg(retInst->get_operand(0), Reg::a(0));
     }
-    auto exit_label = context.func->get_name() + "_exit";  // Enhance
-    append_inst("b " + exit_label);
+    append_inst(ASMOp::B, {context.exit_label});
 }
 
 void CodeGen::insert_phi(Instruction *ins) {
@@ -248,15 +237,15 @@ void CodeGen::gen_br() {
         for (auto& ins : falseBB->get_instructions()) {
             insert_phi(&ins);
         }
-        append_inst("bstrpick.d $t1, $t0, 0, 0");
-        append_inst("bnez", {Reg::t(1).print(), label_name(trueBB)});
-        append_inst("b " + label_name(falseBB));
+        append_inst(ASMOp::BSTRPICK_D, {Reg::t(1), Reg::t(0), 0, 0});
+        append_inst(ASMOp::BNEZ, {Reg::t(1), label_name(trueBB)});
+        append_inst(ASMOp::B, {label_name(falseBB)});
     } else {
         auto* branchBB = static_cast<BasicBlock*>(branchInst->get_operand(0));
         for (auto& ins : branchBB->get_instructions()) {
             insert_phi(&ins);
         }
-        append_inst("b " + label_name(branchBB));
+        append_inst(ASMOp::B, {label_name(branchBB)});
     }
 }
 
@@ -267,16 +256,16 @@ void CodeGen::gen_binary() {
     // 根据指令类型生成汇编
     switch (context.inst->get_instr_type()) {
         case Instruction::add:
-            output.emplace_back("add.w $t2, $t0, $t1");
+            append_inst(ASMOp::ADD_W, {Reg::t(2), Reg::t(0), Reg::t(1)});
             break;
         case Instruction::sub:
-            output.emplace_back("sub.w $t2, $t0, $t1");
+            append_inst(ASMOp::SUB_W, {Reg::t(2), Reg::t(0), Reg::t(1)});
             break;
         case Instruction::mul:
-            output.emplace_back("mul.w $t2, $t0, $t1");
+            append_inst(ASMOp::MUL_W, {Reg::t(2), Reg::t(0), Reg::t(1)});
             break;
         case Instruction::sdiv:
-            output.emplace_back("div.w $t2, $t0, $t1");
+            append_inst(ASMOp::DIV_W, {Reg::t(2), Reg::t(0), Reg::t(1)});
             break;
         default:
             assert(false);
@@ -293,16 +282,16 @@ void CodeGen::gen_float_binary() {
     // 根据指令类型生成汇编
     switch (context.inst->get_instr_type()) {
         case Instruction::fadd:
-            output.emplace_back("fadd.s $ft2, $ft0, $ft1");
+            append_inst(ASMOp::FADD_S, {FReg::ft(2), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::fsub:
-            output.emplace_back("fsub.s $ft2, $ft0, $ft1");
+            append_inst(ASMOp::FSUB_S, {FReg::ft(2), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::fmul:
-            output.emplace_back("fmul.s $ft2, $ft0, $ft1");
+            append_inst(ASMOp::FMUL_S, {FReg::ft(2), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::fdiv:
-            output.emplace_back("fdiv.s $ft2, $ft0, $ft1");
+            append_inst(ASMOp::FDIV_S, {FReg::ft(2), FReg::ft(0), FReg::ft(1)});
             break;
         default:
             assert(false);
@@ -320,7 +309,7 @@ void CodeGen::gen_alloca() {
     auto offset = context.offset_map.at(allocaInst);
     auto size = allocaInst->get_alloca_type()->get_size();
     offset -= size;  // 起始地址
-    append_inst("addi.d", {Reg::t(1).print(), Reg::fp().print(), std::to_string(offset)});
+    append_inst(ASMOp::ADDI_D, {Reg::t(1), Reg::fp(), offset});
     store_from_greg(allocaInst, Reg::t(1));
 }
 
@@ -330,11 +319,11 @@ void CodeGen::gen_load() {
     load_to_greg(ptr, Reg::t(0));
 
     if (type->is_float_type()) {
-        append_inst("fld.s $ft0, $t0, 0");
+        append_inst(ASMOp::FLD_S, {FReg::ft(0), Reg::t(0), 0});
         store_from_freg(context.inst, FReg::ft(0));
     } else {
         // DONE: load 整数类型的数据
-        append_inst("ld.d $t0, $t0, 0");
+        append_inst(ASMOp::LD_D, {Reg::t(0), Reg::t(0), 0});
         store_from_greg(context.inst, Reg::t(0));
     }
 }
@@ -346,13 +335,13 @@ void CodeGen::gen_store() {
     load_to_greg(context.inst->get_operand(1), Reg::t(0));  // Destination
     if (type->is_float_type()) {
         load_to_freg(ptr, FReg::ft(0));
-        append_inst("fst.s $ft0, $t0, 0");
+        append_inst(ASMOp::FST_S, {FReg::ft(0), Reg::t(0), 0});
     } else if (type->is_pointer_type()) {
         load_to_greg(ptr, Reg::t(1));
-        append_inst("st.d $t1, $t0, 0");
+        append_inst(ASMOp::ST_D, {Reg::t(1), Reg::t(0), 0});
     } else {
         load_to_greg(ptr, Reg::t(1));
-        append_inst("st.w $t1, $t0, 0");
+        append_inst(ASMOp::ST_W, {Reg::t(1), Reg::t(0), 0});
     }
 }
 
@@ -363,28 +352,28 @@ void CodeGen::gen_icmp() {
     load_to_greg(icmpInst->get_operand(1), Reg::t(1));  // Operand 2
     switch (icmpInst->get_instr_type()) {
         case Instruction::gt:
-            append_inst("slt $t0, $t1, $t0");
+            append_inst(ASMOp::SLT, {Reg::t(0), Reg::t(1), Reg::t(0)});
             break;
         case Instruction::ge:
-            append_inst("addi.w $t0, $t0, 1");
-            append_inst("slt $t0, $t1, $t0");
+            append_inst(ASMOp::ADDI_W, {Reg::t(0), Reg::t(0), 1});
+            append_inst(ASMOp::SLT, {Reg::t(0), Reg::t(1), Reg::t(0)});
             break;
         case Instruction::eq:
-            append_inst("slt $t2, $t1, $t0");
-            append_inst("slt $t3, $t0, $t1");
-            append_inst("nor $t0, $t2, $t3");
+            append_inst(ASMOp::SLT, {Reg::t(2), Reg::t(1), Reg::t(0)});
+            append_inst(ASMOp::SLT, {Reg::t(3), Reg::t(0), Reg::t(1)});
+            append_inst(ASMOp::NOR, {Reg::t(0), Reg::t(2), Reg::t(3)});
             break;
         case Instruction::ne:
-            append_inst("slt $t2, $t1, $t0");
-            append_inst("slt $t3, $t0, $t1");
-            append_inst("or $t0, $t2, $t3");
+            append_inst(ASMOp::SLT, {Reg::t(2), Reg::t(1), Reg::t(0)});
+            append_inst(ASMOp::SLT, {Reg::t(3), Reg::t(0), Reg::t(1)});
+            append_inst(ASMOp::OR, {Reg::t(0), Reg::t(2), Reg::t(3)});
             break;
         case Instruction::le:
-            append_inst("addi.w $t1, $t1, 1");
-            append_inst("slt $t0, $t0, $t1");
+            append_inst(ASMOp::ADDI_W, {Reg::t(1), Reg::t(1), 1});
+            append_inst(ASMOp::SLT, {Reg::t(0), Reg::t(0), Reg::t(1)});
             break;
         case Instruction::lt:
-            append_inst("slt $t0, $t0, $t1");
+            append_inst(ASMOp::SLT, {Reg::t(0), Reg::t(0), Reg::t(1)});
             break;
         default:
             break;
@@ -399,22 +388,22 @@ void CodeGen::gen_fcmp() {
     load_to_freg(fcmpInst->get_operand(1), FReg::ft(1));  // Operand 2
     switch (fcmpInst->get_instr_type()) {
         case Instruction::fgt:
-            append_inst("fcmp.slt.s $ft0, $ft1, $ft0");
+            append_inst(ASMOp::FCMP_SLT_S, {FReg::ft(0), FReg::ft(1), FReg::ft(0)});
             break;
         case Instruction::fge:
-            append_inst("fcmp.sle.s $ft0, $ft1, $ft0");
+            append_inst(ASMOp::FCMP_SLE_S, {FReg::ft(0), FReg::ft(1), FReg::ft(0)});
             break;
         case Instruction::feq:
-            append_inst("fcmp.seq.s $ft0, $ft0, $ft1");
+            append_inst(ASMOp::FCMP_SEQ_S, {FReg::ft(0), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::fne:
-            append_inst("fcmp.sne.s $ft0, $ft0, $ft1");
+            append_inst(ASMOp::FCMP_SNE_S, {FReg::ft(0), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::fle:
-            append_inst("fcmp.sle.s $ft0, $ft0, $ft1");
+            append_inst(ASMOp::FCMP_SLE_S, {FReg::ft(0), FReg::ft(0), FReg::ft(1)});
             break;
         case Instruction::flt:
-            append_inst("fcmp.slt.s $ft0, $ft0, $ft1");
+            append_inst(ASMOp::FCMP_SLT_S, {FReg::ft(0), FReg::ft(0), FReg::ft(1)});
             break;
         default:
             break;
@@ -426,7 +415,7 @@ void CodeGen::gen_zext() {
     // DONE: 将窄位宽的整数数据进行零扩展
     auto zextInst = static_cast<ZextInst*>(context.inst);
     load_to_greg(zextInst->get_operand(0), Reg::t(0));
-    append_inst("bstrpick.w $t0, $t0, 0, 0");
+    append_inst(ASMOp::BSTRPICK_W, {Reg::t(0), Reg::t(0), 0, 0});
     store_from_greg(zextInst, Reg::t(0));
 }
 
@@ -444,7 +433,7 @@ void CodeGen::gen_call() {
             load_to_greg(arg, Reg::a(gregs++));
         }
     }
-    append_inst("bl", {callInst->get_operand(0)->get_name()});
+    append_inst(ASMOp::BL, {&callInst->get_operand(0)->get_name()});
     if (retType->is_float_type()) {
         store_from_freg(callInst, FReg::fa(0));
     } else if (retType->is_integer_type()) {
@@ -463,17 +452,17 @@ void CodeGen::gen_gep() {
         load_to_greg(gepInst->get_operand(2), Reg::t(2));  // Second operand
         load_large_int32(ptrType->get_element_type()->get_size(), Reg::t(3));
         load_large_int32(ptrType->get_element_type()->get_array_element_type()->get_size(), Reg::t(4));
-        append_inst("mul.w $t1, $t1, $t3");
-        append_inst("bstrpick.d $t1, $t1, 31, 0");
-        append_inst("add.d $t0, $t0, $t1");
-        append_inst("mul.w $t2, $t2, $t4");
-        append_inst("bstrpick.d $t2, $t2, 31, 0");
-        append_inst("add.d $t0, $t0, $t2");
+        append_inst(ASMOp::MUL_W, {Reg::t(1), Reg::t(1), Reg::t(3)});
+        append_inst(ASMOp::BSTRPICK_D, {Reg::t(1), Reg::t(1), 31, 0});
+        append_inst(ASMOp::ADD_D, {Reg::t(0), Reg::t(0), Reg::t(1)});
+        append_inst(ASMOp::MUL_W, {Reg::t(2), Reg::t(2), Reg::t(4)});
+        append_inst(ASMOp::BSTRPICK_D, {Reg::t(2), Reg::t(2), 31, 0});
+        append_inst(ASMOp::ADD_D, {Reg::t(0), Reg::t(0), Reg::t(2)});
     } else {
         load_large_int32(ptrType->get_element_type()->get_size(), Reg::t(2));
-        append_inst("mul.w $t1, $t1, $t2");
-        append_inst("bstrpick.d $t1, $t1, 31, 0");
-        append_inst("add.d $t0, $t0, $t1");
+        append_inst(ASMOp::MUL_W, {Reg::t(1), Reg::t(1), Reg::t(2)});
+        append_inst(ASMOp::BSTRPICK_D, {Reg::t(1), Reg::t(1), 31, 0});
+        append_inst(ASMOp::ADD_D, {Reg::t(0), Reg::t(0), Reg::t(1)});
     }
     store_from_greg(gepInst, Reg::t(0));
 }
@@ -482,8 +471,8 @@ void CodeGen::gen_sitofp() {
     // DONE: 整数转向浮点数
     auto itfInst = static_cast<SiToFpInst*>(context.inst);
     load_to_greg(itfInst->get_operand(0), Reg::t(0));
-    append_inst("movgr2fr.w $ft0, $t0");  // Move to float register
-    append_inst("ffint.s.w $ft1, $ft0");  // Convert to float
+    append_inst(ASMOp::MOVGR2FR_W, {FReg::ft(0), Reg::t(0)});  // Move to float register
+    append_inst(ASMOp::FFINT_S_W, {FReg::ft(1), FReg::ft(0)});  // Convert to float
     store_from_freg(itfInst, FReg::ft(1));
 }
 
@@ -491,7 +480,7 @@ void CodeGen::gen_fptosi() {
     // DONE: 浮点数转向整数，注意向下取整(round to zero)
     auto ftiInst = static_cast<FpToSiInst*>(context.inst);
     load_to_freg(ftiInst->get_operand(0), FReg::ft(0));
-    append_inst("ftintrz.w.s $ft1, $ft0");  // Convert to int
+    append_inst(ASMOp::FTINTRZ_W_S, {FReg::ft(1), FReg::ft(0)});  // Convert to int
     store_from_freg(ftiInst, FReg::ft(1));
 }
 
@@ -505,44 +494,43 @@ void CodeGen::run() {
      * 要将 `a` 的地址载入 $t0, 只需要 `la.local $t0, a`
      */
     if (!m->get_global_variable().empty()) {
-        append_inst("Global variables", ASMInstruction::Comment);
+        append_inst(ASMOp::COMMENT,
+                    {m->get_string_pool().intern("Global variables")});
         /* 虽然下面两条伪指令可以简化为一条 `.bss` 伪指令, 但是我们还是选择使用
          * `.section` 将全局变量放到可执行文件的 BSS 段, 原因如下:
          * - 尽可能对齐交叉编译器 loongarch64-unknown-linux-gnu-gcc 的行为
          * - 支持更旧版本的 GNU 汇编器, 因为 `.bss` 伪指令是应该相对较新的指令,
          *   GNU 汇编器在 2023 年 2 月的 2.37 版本才将其引入
          */
-        append_inst(".text", ASMInstruction::Atrribute);
-        append_inst(".section", {".bss", "\"aw\"", "@nobits"},
-                    ASMInstruction::Atrribute);
+        append_inst(ASMOp::TEXT);
+        append_inst(ASMOp::SECTION_BSS);
         for (auto& global : m->get_global_variable()) {
             auto size =
                 global.get_type()->get_pointer_element_type()->get_size();
-            append_inst(".globl", {global.get_name()},
-                        ASMInstruction::Atrribute);
-            append_inst(".type", {global.get_name(), "@object"},
-                        ASMInstruction::Atrribute);
-            append_inst(".size", {global.get_name(), std::to_string(size)},
-                        ASMInstruction::Atrribute);
-            append_inst(global.get_name(), ASMInstruction::Label);
-            append_inst(".space", {std::to_string(size)},
-                        ASMInstruction::Atrribute);
+            auto name = &global.get_name();
+            append_inst(ASMOp::GLOBL, {name});
+            append_inst(ASMOp::TYPE_OBJECT, {name});
+            append_inst(ASMOp::SIZE, {name, size});
+            append_inst(ASMOp::LABEL, {name});
+            append_inst(ASMOp::SPACE, {size});
         }
     }
 
     // 函数代码段
-    output.emplace_back(".text", ASMInstruction::Atrribute);
+    append_inst(ASMOp::TEXT);
     for (auto& func : m->get_functions()) {
         if (not func.is_declaration()) {
             // 更新 context
             context.clear();
             context.func = &func;
+            context.exit_label =
+                m->get_string_pool().intern(func.get_name() + "_exit");
 
             // 函数信息
-            append_inst(".globl", {func.get_name()}, ASMInstruction::Atrribute);
-            append_inst(".type", {func.get_name(), "@function"},
-                        ASMInstruction::Atrribute);
-            append_inst(func.get_name(), ASMInstruction::Label);
+            auto name = &func.get_name();
+            append_inst(ASMOp::GLOBL, {name});
+            append_inst(ASMOp::TYPE_FUNCTION, {name});
+            append_inst(ASMOp::LABEL, {name});
 
             // 分配函数栈帧
             allocate();
@@ -550,10 +538,10 @@ void CodeGen::run() {
             gen_prologue();
 
             for (auto& bb : func.get_basic_blocks()) {
-                append_inst(label_name(&bb), ASMInstruction::Label);
+                append_inst(ASMOp::LABEL, {label_name(&bb)});
                 for (auto& ins : bb.get_instructions()) {
-                    // For debug
-                    append_inst(ins.print(), ASMInstruction::Comment);
+                    // For debug, 打印时才输出 IR 文本
+                    output.emplace_back(&ins);
                     context.inst = &ins;  // 更新 context
                     switch (ins.get_instr_type()) {
                         case Instruction::ret:
@@ -625,10 +613,49 @@ void CodeGen::run() {
     }
 }
 
-std::string CodeGen::print() const {
-    std::string result;
+void CodeGen::append_inst(const std::string& content,
+                          ASMInstruction::InstType ty) {
+    auto text = m->get_string_pool().intern(content);
+    switch (ty) {
+        case ASMInstruction::Instruction:
+        case ASMInstruction::Atrribute:
+            append_inst(ASMOp::RAW, {text});
+            break;
+        case ASMInstruction::Label:
+            append_inst(ASMOp::LABEL, {text});
+            break;
+        case ASMInstruction::Comment:
+            append_inst(ASMOp::COMMENT, {text});
+            break;
+    }
+}
+
+void CodeGen::append_inst(const char* inst,
+                          std::initializer_list<std::string> args,
+                          ASMInstruction::InstType ty) {
+    auto content = std::string(inst) + " ";
+    for (const auto& arg : args) {
+        content += arg + ", ";
+    }
+    content.pop_back();
+    content.pop_back();
+    append_inst(content, ty);
+}
+
+void CodeGen::print(llvm::raw_ostream& os) const {
     for (const auto& inst : output) {
-        result += inst.format();
+        inst.print(os);
     }
+}
+
+std::string CodeGen::print() const {
+    std::string result;
+    llvm::raw_string_ostream os(result);
+    print(os);
+    os.flush();
     return result;
 }
+
+bool CodeGen::emit_object(llvm::raw_ostream& os, std::string& err) const {
+    return write_object(output, os, err);
+}
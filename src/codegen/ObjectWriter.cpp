@@ -0,0 +1,363 @@
+#include "ObjectWriter.hpp"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/BinaryFormat/ELF.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+namespace ELF = llvm::ELF;
+
+namespace {
+
+// LLVM 14 中还没有 LoongArch 的定义, 取值见 LoongArch ELF psABI
+constexpr uint16_t EM_LOONGARCH = 258;
+constexpr uint32_t EF_LOONGARCH_ABI_DOUBLE_FLOAT = 0x3;
+constexpr uint32_t EF_LOONGARCH_OBJABI_V1 = 0x40;
+constexpr uint32_t R_LARCH_B21 = 65;
+constexpr uint32_t R_LARCH_B26 = 66;
+constexpr uint32_t R_LARCH_PCALA_HI20 = 71;
+constexpr uint32_t R_LARCH_PCALA_LO12 = 72;
+
+// 节在节头表中的下标, 也是写入文件的顺序
+enum SectionIndex : uint16_t {
+    SEC_NULL,
+    SEC_TEXT,
+    SEC_RELA_TEXT,
+    SEC_BSS,
+    SEC_NOTE_GNU_STACK,
+    SEC_SYMTAB,
+    SEC_STRTAB,
+    SEC_SHSTRTAB,
+    NUM_SECTIONS,
+};
+
+constexpr uint64_t EHDR_SIZE = 64;
+constexpr uint64_t SHDR_SIZE = 64;
+constexpr uint64_t SYM_SIZE = 24;
+constexpr uint64_t RELA_SIZE = 24;
+
+struct Section {
+    const char *name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t align;
+    uint64_t entsize;
+    uint32_t link{0};
+    uint32_t info{0};
+    std::string data;
+    uint64_t size{0}; // 与 data 的长度不同时 (.bss) 才需要设置
+    uint64_t offset{0};
+    uint32_t name_offset{0};
+};
+
+struct Symbol {
+    StringPool::Handle name;
+    uint16_t section{ELF::SHN_UNDEF};
+    uint8_t type{ELF::STT_NOTYPE};
+    bool global{false};
+    uint64_t value{0};
+    uint64_t size{0};
+    uint32_t index{0}; // 在 .symtab 中的下标
+};
+
+struct Reloc {
+    uint64_t offset;
+    unsigned symbol; // 在 symbols_ 中的下标
+    uint32_t type;
+};
+
+class ObjectWriter {
+  public:
+    explicit ObjectWriter(const std::vector<ASMInstruction> &insts)
+        : insts_(insts) {}
+
+    bool write(llvm::raw_ostream &os, std::string &err);
+
+  private:
+    // 第一遍: 确定标签的地址和符号的属性, 遇到无法编码的指令时返回 false
+    bool define_symbols(std::string &err);
+    // 第二遍: 生成机器码, 本地跳转直接填写偏移, 其余留给重定位
+    void encode_text();
+    void build_symtab();
+    void build_rela_text();
+
+    // 符号名为 interned 字符串, 地址即可区分
+    unsigned get_symbol(StringPool::Handle name);
+
+    const std::vector<ASMInstruction> &insts_;
+
+    llvm::DenseMap<StringPool::Handle, unsigned> symbol_ids_;
+    std::vector<Symbol> symbols_;
+    std::vector<Reloc> relocs_;
+    uint64_t text_size_{0};
+    uint64_t bss_size_{0};
+
+    Section sections_[NUM_SECTIONS] = {
+        {"", ELF::SHT_NULL, 0, 0, 0},
+        {".text", ELF::SHT_PROGBITS, ELF::SHF_ALLOC | ELF::SHF_EXECINSTR, 4,
+         0},
+        {".rela.text", ELF::SHT_RELA, ELF::SHF_INFO_LINK, 8, RELA_SIZE},
+        {".bss", ELF::SHT_NOBITS, ELF::SHF_ALLOC | ELF::SHF_WRITE, 8, 0},
+        {".note.GNU-stack", ELF::SHT_PROGBITS, 0, 1, 0},
+        {".symtab", ELF::SHT_SYMTAB, 0, 8, SYM_SIZE},
+        {".strtab", ELF::SHT_STRTAB, 0, 1, 0},
+        {".shstrtab", ELF::SHT_STRTAB, 0, 1, 0},
+    };
+};
+
+unsigned ObjectWriter::get_symbol(StringPool::Handle name) {
+    auto [it, inserted] = symbol_ids_.try_emplace(name, symbols_.size());
+    if (inserted)
+        symbols_.push_back({name});
+    return it->second;
+}
+
+bool ObjectWriter::define_symbols(std::string &err) {
+    uint16_t section = SEC_TEXT;
+    for (auto &inst : insts_) {
+        switch (inst.op) {
+        case ASMOp::TEXT:
+            section = SEC_TEXT;
+            break;
+        case ASMOp::SECTION_BSS:
+            section = SEC_BSS;
+            break;
+        case ASMOp::GLOBL:
+            symbols_[get_symbol(inst.symbol)].global = true;
+            break;
+        case ASMOp::TYPE_OBJECT:
+            symbols_[get_symbol(inst.symbol)].type = ELF::STT_OBJECT;
+            break;
+        case ASMOp::TYPE_FUNCTION:
+            symbols_[get_symbol(inst.symbol)].type = ELF::STT_FUNC;
+            break;
+        case ASMOp::SIZE:
+            symbols_[get_symbol(inst.symbol)].size = inst.imms[0];
+            break;
+        case ASMOp::LABEL: {
+            auto &sym = symbols_[get_symbol(inst.symbol)];
+            assert(sym.section == ELF::SHN_UNDEF && "label defined twice");
+            sym.section = section;
+            sym.value = section == SEC_TEXT ? text_size_ : bss_size_;
+            break;
+        }
+        case ASMOp::SPACE:
+            assert(section == SEC_BSS && "only .bss is supported for .space");
+            bss_size_ += inst.imms[0];
+            break;
+        case ASMOp::COMMENT:
+        case ASMOp::IR_COMMENT:
+            break;
+        case ASMOp::RAW:
+            err = "cannot encode '" + *inst.symbol + "' into an object file";
+            return false;
+        default:
+            assert(section == SEC_TEXT && "instruction outside .text");
+            text_size_ += inst.get_size();
+            break;
+        }
+    }
+    return true;
+}
+
+void ObjectWriter::encode_text() {
+    llvm::raw_string_ostream os(sections_[SEC_TEXT].data);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    uint64_t pc = 0;
+    for (auto &inst : insts_) {
+        auto size = inst.get_size();
+        if (size == 0)
+            continue;
+
+        int32_t offset = 0;
+        switch (inst.op) {
+        case ASMOp::B:
+        case ASMOp::BNEZ:
+        case ASMOp::BL: {
+            auto id = get_symbol(inst.symbol);
+            auto &sym = symbols_[id];
+            // 与汇编器一致, 跳转到全局符号时总是留给链接器
+            if (not sym.global and sym.section == SEC_TEXT)
+                offset = static_cast<int32_t>(sym.value - pc);
+            else if (inst.op == ASMOp::BNEZ)
+                relocs_.push_back({pc, id, R_LARCH_B21});
+            else
+                relocs_.push_back({pc, id, R_LARCH_B26});
+            break;
+        }
+        case ASMOp::LA_LOCAL: {
+            auto id = get_symbol(inst.symbol);
+            relocs_.push_back({pc, id, R_LARCH_PCALA_HI20});
+            relocs_.push_back({pc + 4, id, R_LARCH_PCALA_LO12});
+            break;
+        }
+        default:
+            break;
+        }
+
+        uint32_t code[2];
+        auto num = inst.encode(code, offset);
+        assert(num * 4 == size && "unexpected instruction size");
+        for (unsigned i = 0; i < num; i++)
+            writer.write<uint32_t>(code[i]);
+        pc += size;
+    }
+    os.flush();
+    assert(pc == text_size_ && "labels and code disagree");
+}
+
+void ObjectWriter::build_symtab() {
+    auto &symtab = sections_[SEC_SYMTAB];
+    auto &strtab = sections_[SEC_STRTAB];
+    llvm::raw_string_ostream os(symtab.data);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    strtab.data.push_back('\0');
+
+    auto write_sym = [&](uint32_t name, uint8_t info, uint16_t shndx,
+                         uint64_t value, uint64_t size) {
+        writer.write<uint32_t>(name);
+        writer.write<uint8_t>(info);
+        writer.write<uint8_t>(ELF::STV_DEFAULT);
+        writer.write<uint16_t>(shndx);
+        writer.write<uint64_t>(value);
+        writer.write<uint64_t>(size);
+    };
+    auto write_symbol = [&](Symbol &sym) {
+        uint32_t name = strtab.data.size();
+        strtab.data += *sym.name;
+        strtab.data.push_back('\0');
+        auto bind = sym.global ? ELF::STB_GLOBAL : ELF::STB_LOCAL;
+        write_sym(name, bind << 4 | sym.type, sym.section, sym.value,
+                  sym.size);
+    };
+
+    // 局部符号必须排在全局符号之前
+    uint32_t index = 0;
+    write_sym(0, 0, ELF::SHN_UNDEF, 0, 0);
+    index++;
+    for (uint16_t sec : {SEC_TEXT, SEC_BSS}) {
+        write_sym(0, ELF::STB_LOCAL << 4 | ELF::STT_SECTION, sec, 0, 0);
+        index++;
+    }
+    for (auto &sym : symbols_) {
+        // 未定义的符号由其他目标文件提供
+        if (sym.section == ELF::SHN_UNDEF)
+            sym.global = true;
+        if (not sym.global) {
+            sym.index = index++;
+            write_symbol(sym);
+        }
+    }
+    symtab.info = index;
+    for (auto &sym : symbols_) {
+        if (sym.global) {
+            sym.index = index++;
+            write_symbol(sym);
+        }
+    }
+    symtab.link = SEC_STRTAB;
+    os.flush();
+}
+
+void ObjectWriter::build_rela_text() {
+    auto &rela = sections_[SEC_RELA_TEXT];
+    llvm::raw_string_ostream os(rela.data);
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    for (auto &reloc : relocs_) {
+        uint64_t sym = symbols_[reloc.symbol].index;
+        writer.write<uint64_t>(reloc.offset);
+        writer.write<uint64_t>(sym << 32 | reloc.type);
+        writer.write<int64_t>(0); // addend
+    }
+    rela.link = SEC_SYMTAB;
+    rela.info = SEC_TEXT;
+    os.flush();
+}
+
+bool ObjectWriter::write(llvm::raw_ostream &os, std::string &err) {
+    if (not define_symbols(err))
+        return false;
+    encode_text();
+    build_symtab();
+    build_rela_text();
+    sections_[SEC_BSS].size = bss_size_;
+
+    auto &shstrtab = sections_[SEC_SHSTRTAB].data;
+    for (auto &sec : sections_) {
+        sec.name_offset = shstrtab.size();
+        shstrtab += sec.name;
+        shstrtab.push_back('\0');
+    }
+
+    // 依次排列各节的内容, 节头表放在最后
+    uint64_t offset = EHDR_SIZE;
+    for (auto &sec : sections_) {
+        if (sec.type != ELF::SHT_NOBITS)
+            sec.size = sec.data.size();
+        if (sec.type == ELF::SHT_NULL)
+            continue;
+        offset = llvm::alignTo(offset, sec.align);
+        sec.offset = offset;
+        offset += sec.data.size();
+    }
+    uint64_t shoff = llvm::alignTo(offset, 8);
+
+    llvm::support::endian::Writer writer(os, llvm::support::little);
+    // ELF 头
+    os.write(ELF::ElfMagic, 4);
+    writer.write<uint8_t>(ELF::ELFCLASS64);
+    writer.write<uint8_t>(ELF::ELFDATA2LSB);
+    writer.write<uint8_t>(ELF::EV_CURRENT);
+    writer.write<uint8_t>(ELF::ELFOSABI_NONE);
+    os.write_zeros(ELF::EI_NIDENT - ELF::EI_ABIVERSION);
+    writer.write<uint16_t>(ELF::ET_REL);
+    writer.write<uint16_t>(EM_LOONGARCH);
+    writer.write<uint32_t>(ELF::EV_CURRENT);
+    writer.write<uint64_t>(0); // e_entry
+    writer.write<uint64_t>(0); // e_phoff
+    writer.write<uint64_t>(shoff);
+    writer.write<uint32_t>(EF_LOONGARCH_OBJABI_V1 |
+                           EF_LOONGARCH_ABI_DOUBLE_FLOAT);
+    writer.write<uint16_t>(EHDR_SIZE);
+    writer.write<uint16_t>(0); // e_phentsize
+    writer.write<uint16_t>(0); // e_phnum
+    writer.write<uint16_t>(SHDR_SIZE);
+    writer.write<uint16_t>(NUM_SECTIONS);
+    writer.write<uint16_t>(SEC_SHSTRTAB);
+
+    // 各节内容
+    uint64_t pos = EHDR_SIZE;
+    for (auto &sec : sections_) {
+        if (sec.data.empty())
+            continue;
+        os.write_zeros(sec.offset - pos);
+        os << sec.data;
+        pos = sec.offset + sec.data.size();
+    }
+    os.write_zeros(shoff - pos);
+
+    // 节头表
+    for (auto &sec : sections_) {
+        writer.write<uint32_t>(sec.name_offset);
+        writer.write<uint32_t>(sec.type);
+        writer.write<uint64_t>(sec.flags);
+        writer.write<uint64_t>(0); // sh_addr
+        writer.write<uint64_t>(sec.offset);
+        writer.write<uint64_t>(sec.size);
+        writer.write<uint32_t>(sec.link);
+        writer.write<uint32_t>(sec.info);
+        writer.write<uint64_t>(sec.align);
+        writer.write<uint64_t>(sec.entsize);
+    }
+    return true;
+}
+
+} // namespace
+
+bool write_object(const std::vector<ASMInstruction> &insts,
+                  llvm::raw_ostream &os, std::string &err) {
+    return ObjectWriter(insts).write(os, err);
+}
@@ -1,41 +1,30 @@
 #include "Register.hpp"
-#include <string>
 
-std::string Reg::print() const {
-    if (id == 0) {
-        return "$zero";
-    }
-    if (id == 1) {
-        return "$ra";
-    }
-    if (id == 2) {
-        return "$tp";
-    }
-    if (id == 3) {
-        return "$sp";
-    }
-    if (4 <= id and id <= 11) {
-        return "$a" + std::to_string(id - 4);
-    }
-    if (12 <= id and id <= 20) {
-        return "$t" + std::to_string(id - 12);
-    }
-    if (id == 22) {
-        return "$fp";
-    }
-    assert(false);
+const char *Reg::print() const {
+    static const char *const names[] = {
+        "$zero", "$ra", "$tp", "$sp", "$a0", "$a1", "$a2", "$a3",
+        "$a4",   "$a5", "$a6", "$a7", "$t0", "$t1", "$t2", "$t3",
+        "$t4",   "$t5", "$t6", "$t7", "$t8", "$r21", "$fp", "$s0",
+        "$s1",   "$s2", "$s3", "$s4", "$s5", "$s6", "$s7", "$s8",
+    };
+    return names[id];
 }
 
-std::string FReg::print() const {
+const char *FReg::print() const {
+    static const char *const names[] = {
+        "$fa0",  "$fa1",  "$fa2",  "$fa3",  "$fa4",  "$fa5",  "$fa6",
+        "$fa7",  "$ft0",  "$ft1",  "$ft2",  "$ft3",  "$ft4",  "$ft5",
+        "$ft6",  "$ft7",  "$ft8",  "$ft9",  "$ft10", "$ft11", "$ft12",
+        "$ft13", "$ft14", "$ft15", "$fs0",  "$fs1",  "$fs2",  "$fs3",
+        "$fs4",  "$fs5",  "$fs6",  "$fs7",
+    };
+    return names[id];
+}
 
-    if (0 <= id and id <= 7) {
-        return "$fa" + std::to_string(id);
-    }
-    if (8 <= id and id <= 23) {
-        return "$ft" + std::to_string(id - 8);
-    }
-    if (24 <= id and id <= 31) {
-        return "$fs" + std::to_string(id - 24);
-    }
-    assert(false);
+const char *CFReg::print() const {
+    static const char *const names[] = {
+        "$fcc0", "$fcc1", "$fcc2", "$fcc3",
+        "$fcc4", "$fcc5", "$fcc6", "$fcc7",
+    };
+    return names[id];
 }
@@ -0,0 +1,52 @@
+#include "Arena.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+Arena::~Arena() {
+    for (auto slab : slabs_)
+        std::free(slab);
+}
+
+void *Arena::allocate(std::size_t size, std::size_t align) {
+    assert(align <= SIZE_CLASS_ALIGN && "Arena: over-aligned allocation");
+    auto cls = size_class(size);
+    if (cls < NUM_SIZE_CLASSES and free_lists_[cls]) {
+        auto node = free_lists_[cls];
+        free_lists_[cls] = node->next;
+        return node;
+    }
+    auto bytes = cls * SIZE_CLASS_ALIGN;
+    if (static_cast<std::size_t>(end_ - cur_) < bytes)
+        return allocate_slow(bytes);
+    auto ptr = cur_;
+    cur_ += bytes;
+    return ptr;
+}
+
+void Arena::deallocate(void *ptr, std::size_t size) {
+    if (ptr == nullptr)
+        return;
+    auto cls = size_class(size);
+    // oversized nodes stay in their slab until the arena dies
+    if (cls >= NUM_SIZE_CLASSES)
+        return;
+    auto node = static_cast<FreeNode *>(ptr);
+    node->next = free_lists_[cls];
+    free_lists_[cls] = node;
+}
+
+void *Arena::allocate_slow(std::size_t bytes) {
+    auto slab_size = bytes > SLAB_SIZE ? bytes : SLAB_SIZE;
+    // malloc returns memory aligned for std::max_align_t
+    auto slab = static_cast<char *>(std::malloc(slab_size));
+    if (slab == nullptr)
+        throw std::bad_alloc();
+    slabs_.push_back(slab);
+    if (bytes > SLAB_SIZE) // dedicated slab, keep bumping the current one
+        return slab;
+    cur_ = slab + bytes;
+    end_ = slab + slab_size;
+    return slab;
+}
@@ -1,6 +1,7 @@
 #include "ast.hpp"
 
-#include <cstring>
+#include "cminus_grammar.h"
+
 #include <iostream>
 #include <stack>
 
@@ -9,23 +10,29 @@
                  "Contact with TAs to solve your problem."                     \
               << std::endl;                                                    \
     std::abort();
-#define _STR_EQ(a, b) (strcmp((a), (b)) == 0)
 
 void AST::run_visitor(ASTVisitor &visitor) { root->accept(visitor); }
 
-AST::AST(syntax_tree *s) {
+AST::AST(syntax_tree *s) : arena(std::make_unique<Arena>()) {
     if (s == nullptr) {
         std::cerr << "empty input tree!" << std::endl;
         std::abort();
     }
     auto node = transform_node_iter(s->root);
     del_syntax_tree(s);
-    root = std::shared_ptr<ASTProgram>(static_cast<ASTProgram *>(node));
+    root = static_cast<ASTProgram *>(node);
+}
+
+std::string_view AST::create_id(std::string_view text) {
+    auto data = static_cast<char *>(arena->allocate(text.size(), 1));
+    std::copy(text.begin(), text.end(), data);
+    return {data, text.size()};
 }
 
 ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
-    if (_STR_EQ(n->name, "program")) {
-        auto node = new ASTProgram();
+    switch (n->kind) {
+    case NODE_PROGRAM: {
+        auto node = create<ASTProgram>();
 
         // flatten declaration list
         std::stack<syntax_tree_node *> s;
@@ -36,32 +43,32 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
         }
         s.push(list_ptr->children[0]);
 
+        std::vector<ASTDeclaration *> declarations;
         while (!s.empty()) {
             auto child_node =
                 static_cast<ASTDeclaration *>(transform_node_iter(s.top()));
-
-            auto child_node_shared =
-                std::shared_ptr<ASTDeclaration>(child_node);
-            node->declarations.push_back(child_node_shared);
+            declarations.push_back(child_node);
             s.pop();
         }
+        node->declarations = create_list(declarations);
         return node;
-    } else if (_STR_EQ(n->name, "declaration")) {
+    }
+    case NODE_DECLARATION:
         return transform_node_iter(n->children[0]);
-    } else if (_STR_EQ(n->name, "var-declaration")) {
-        auto node = new ASTVarDeclaration();
+    case NODE_VAR_DECLARATION: {
+        auto node = create<ASTVarDeclaration>();
 
-        if (_STR_EQ(n->children[0]->children[0]->name, "int"))
+        if (n->children[0]->children[0]->kind == INT)
             node->type = TYPE_INT;
         else
             node->type = TYPE_FLOAT;
 
         if (n->children_num == 3) {
-            node->id = n->children[1]->name;
+            node->id = create_id(n->children[1]->name);
         } else if (n->children_num == 6) {
-            node->id = n->children[1]->name;
+            node->id = create_id(n->children[1]->name);
             int num = std::stoi(n->children[3]->name);
-            auto num_node = std::make_shared<ASTNum>();
+            auto num_node = create<ASTNum>();
             num_node->i_val = num;
             num_node->type = TYPE_INT;
             node->num = num_node;
@@ -71,17 +78,18 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
             std::abort();
         }
         return node;
-    } else if (_STR_EQ(n->name, "fun-declaration")) {
-        auto node = new ASTFunDeclaration();
-        if (_STR_EQ(n->children[0]->children[0]->name, "int")) {
+    }
+    case NODE_FUN_DECLARATION: {
+        auto node = create<ASTFunDeclaration>();
+        if (n->children[0]->children[0]->kind == INT) {
             node->type = TYPE_INT;
-        } else if (_STR_EQ(n->children[0]->children[0]->name, "float")) {
+        } else if (n->children[0]->children[0]->kind == FLOAT) {
             node->type = TYPE_FLOAT;
         } else {
             node->type = TYPE_VOID;
         }
 
-        node->id = n->children[1]->name;
+        node->id = create_id(n->children[1]->name);
 
         // flatten params
         std::stack<syntax_tree_node *> s;
@@ -95,32 +103,34 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
             }
             s.push(list_ptr->children[0]);
 
+            std::vector<ASTParam *> params;
             while (!s.empty()) {
                 auto child_node =
                     static_cast<ASTParam *>(transform_node_iter(s.top()));
-
-                auto child_node_shared = std::shared_ptr<ASTParam>(child_node);
-                node->params.push_back(child_node_shared);
+                params.push_back(child_node);
                 s.pop();
             }
+            node->params = create_list(params);
         }
 
         auto stmt_node =
             static_cast<ASTCompoundStmt *>(transform_node_iter(n->children[5]));
-        node->compound_stmt = std::shared_ptr<ASTCompoundStmt>(stmt_node);
+        node->compound_stmt = stmt_node;
         return node;
-    } else if (_STR_EQ(n->name, "param")) {
-        auto node = new ASTParam();
-        if (_STR_EQ(n->children[0]->children[0]->name, "int"))
+    }
+    case NODE_PARAM: {
+        auto node = create<ASTParam>();
+        if (n->children[0]->children[0]->kind == INT)
             node->type = TYPE_INT;
         else
             node->type = TYPE_FLOAT;
-        node->id = n->children[1]->name;
+        node->id = create_id(n->children[1]->name);
         if (n->children_num > 2)
             node->isarray = true;
         return node;
-    } else if (_STR_EQ(n->name, "compound-stmt")) {
-        auto node = new ASTCompoundStmt();
+    }
+    case NODE_COMPOUND_STMT: {
+        auto node = create<ASTCompoundStmt>();
         if (n->children[1]->children_num == 2) {
             // flatten local declarations
             auto list_ptr = n->children[1];
@@ -130,14 +140,14 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
                 list_ptr = list_ptr->children[0];
             }
 
+            std::vector<ASTVarDeclaration *> local_declarations;
             while (!s.empty()) {
                 auto decl_node = static_cast<ASTVarDeclaration *>(
                     transform_node_iter(s.top()));
-                auto decl_node_ptr =
-                    std::shared_ptr<ASTVarDeclaration>(decl_node);
-                node->local_declarations.push_back(decl_node_ptr);
+                local_declarations.push_back(decl_node);
                 s.pop();
             }
+            node->local_declarations = create_list(local_declarations);
         }
 
         if (n->children[2]->children_num == 2) {
@@ -149,185 +159,187 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
                 list_ptr = list_ptr->children[0];
             }
 
+            std::vector<ASTStatement *> statement_list;
             while (!s.empty()) {
                 auto stmt_node =
                     static_cast<ASTStatement *>(transform_node_iter(s.top()));
-                auto stmt_node_ptr = std::shared_ptr<ASTStatement>(stmt_node);
-                node->statement_list.push_back(stmt_node_ptr);
+                statement_list.push_back(stmt_node);
                 s.pop();
             }
+            node->statement_list = create_list(statement_list);
         }
         return node;
-    } else if (_STR_EQ(n->name, "statement")) {
+    }
+    case NODE_STATEMENT:
         return transform_node_iter(n->children[0]);
-    } else if (_STR_EQ(n->name, "expression-stmt")) {
-        auto node = new ASTExpressionStmt();
+    case NODE_EXPRESSION_STMT: {
+        auto node = create<ASTExpressionStmt>();
         if (n->children_num == 2) {
             auto expr_node = static_cast<ASTExpression *>(
                 transform_node_iter(n->children[0]));
-
-            auto expr_node_ptr = std::shared_ptr<ASTExpression>(expr_node);
-            node->expression = expr_node_ptr;
+            node->expression = expr_node;
         }
         return node;
-    } else if (_STR_EQ(n->name, "selection-stmt")) {
-        auto node = new ASTSelectionStmt();
+    }
+    case NODE_SELECTION_STMT: {
+        auto node = create<ASTSelectionStmt>();
 
         auto expr_node =
             static_cast<ASTExpression *>(transform_node_iter(n->children[2]));
-        auto expr_node_ptr = std::shared_ptr<ASTExpression>(expr_node);
-        node->expression = expr_node_ptr;
+        node->expression = expr_node;
 
         auto if_stmt_node =
             static_cast<ASTStatement *>(transform_node_iter(n->children[4]));
-        auto if_stmt_node_ptr = std::shared_ptr<ASTStatement>(if_stmt_node);
-        node->if_statement = if_stmt_node_ptr;
+        node->if_statement = if_stmt_node;
 
         // check whether this selection statement contains
         // else structure
         if (n->children_num == 7) {
             auto else_stmt_node = static_cast<ASTStatement *>(
                 transform_node_iter(n->children[6]));
-            auto else_stmt_node_ptr =
-                std::shared_ptr<ASTStatement>(else_stmt_node);
-            node->else_statement = else_stmt_node_ptr;
+            node->else_statement = else_stmt_node;
         }
 
         return node;
-    } else if (_STR_EQ(n->name, "iteration-stmt")) {
-        auto node = new ASTIterationStmt();
+    }
+    case NODE_ITERATION_STMT: {
+        auto node = create<ASTIterationStmt>();
 
         auto expr_node =
             static_cast<ASTExpression *>(transform_node_iter(n->children[2]));
-        auto expr_node_ptr = std::shared_ptr<ASTExpression>(expr_node);
-        node->expression = expr_node_ptr;
+        node->expression = expr_node;
 
         auto stmt_node =
             static_cast<ASTStatement *>(transform_node_iter(n->children[4]));
-        auto stmt_node_ptr = std::shared_ptr<ASTStatement>(stmt_node);
-        node->statement = stmt_node_ptr;
+        node->statement = stmt_node;
 
         return node;
-    } else if (_STR_EQ(n->name, "return-stmt")) {
-        auto node = new ASTReturnStmt();
+    }
+    case NODE_RETURN_STMT: {
+        auto node = create<ASTReturnStmt>();
         if (n->children_num == 3) {
             auto expr_node = static_cast<ASTExpression *>(
                 transform_node_iter(n->children[1]));
-            node->expression = std::shared_ptr<ASTExpression>(expr_node);
+            node->expression = expr_node;
         }
         return node;
-    } else if (_STR_EQ(n->name, "expression")) {
+    }
+    case NODE_EXPRESSION: {
         // simple-expression
         if (n->children_num == 1) {
             return transform_node_iter(n->children[0]);
         }
-        auto node = new ASTAssignExpression();
+        auto node = create<ASTAssignExpression>();
 
         auto var_node =
             static_cast<ASTVar *>(transform_node_iter(n->children[0]));
-        node->var = std::shared_ptr<ASTVar>(var_node);
+        node->var = var_node;
 
         auto expr_node =
             static_cast<ASTExpression *>(transform_node_iter(n->children[2]));
-        node->expression = std::shared_ptr<ASTExpression>(expr_node);
+        node->expression = expr_node;
 
         return node;
-    } else if (_STR_EQ(n->name, "var")) {
-        auto node = new ASTVar();
-        node->id = n->children[0]->name;
+    }
+    case NODE_VAR: {
+        auto node = create<ASTVar>();
+        node->id = create_id(n->children[0]->name);
         if (n->children_num == 4) {
             auto expr_node = static_cast<ASTExpression *>(
                 transform_node_iter(n->children[2]));
-            node->expression = std::shared_ptr<ASTExpression>(expr_node);
+            node->expression = expr_node;
         }
         return node;
-    } else if (_STR_EQ(n->name, "simple-expression")) {
-        auto node = new ASTSimpleExpression();
+    }
+    case NODE_SIMPLE_EXPRESSION: {
+        auto node = create<ASTSimpleExpression>();
         auto expr_node_1 = static_cast<ASTAdditiveExpression *>(
             transform_node_iter(n->children[0]));
         node->additive_expression_l =
-            std::shared_ptr<ASTAdditiveExpression>(expr_node_1);
+            expr_node_1;
 
         if (n->children_num == 3) {
-            auto op_name = n->children[1]->children[0]->name;
-            if (_STR_EQ(op_name, "<="))
+            auto op = n->children[1]->children[0]->kind;
+            if (op == LEQ)
                 node->op = OP_LE;
-            else if (_STR_EQ(op_name, "<"))
+            else if (op == LT)
                 node->op = OP_LT;
-            else if (_STR_EQ(op_name, ">"))
+            else if (op == GT)
                 node->op = OP_GT;
-            else if (_STR_EQ(op_name, ">="))
+            else if (op == GEQ)
                 node->op = OP_GE;
-            else if (_STR_EQ(op_name, "=="))
+            else if (op == EQ)
                 node->op = OP_EQ;
-            else if (_STR_EQ(op_name, "!="))
+            else if (op == NEQ)
                 node->op = OP_NEQ;
 
             auto expr_node_2 = static_cast<ASTAdditiveExpression *>(
                 transform_node_iter(n->children[2]));
             node->additive_expression_r =
-                std::shared_ptr<ASTAdditiveExpression>(expr_node_2);
+                expr_node_2;
         }
         return node;
-    } else if (_STR_EQ(n->name, "additive-expression")) {
-        auto node = new ASTAdditiveExpression();
+    }
+    case NODE_ADDITIVE_EXPRESSION: {
+        auto node = create<ASTAdditiveExpression>();
         if (n->children_num == 3) {
             auto add_expr_node = static_cast<ASTAdditiveExpression *>(
                 transform_node_iter(n->children[0]));
             node->additive_expression =
-                std::shared_ptr<ASTAdditiveExpression>(add_expr_node);
+                add_expr_node;
 
-            auto op_name = n->children[1]->children[0]->name;
-            if (_STR_EQ(op_name, "+"))
+            auto op = n->children[1]->children[0]->kind;
+            if (op == ADD)
                 node->op = OP_PLUS;
-            else if (_STR_EQ(op_name, "-"))
+            else if (op == SUB)
                 node->op = OP_MINUS;
 
             auto term_node =
                 static_cast<ASTTerm *>(transform_node_iter(n->children[2]));
-            node->term = std::shared_ptr<ASTTerm>(term_node);
+            node->term = term_node;
         } else {
             auto term_node =
                 static_cast<ASTTerm *>(transform_node_iter(n->children[0]));
-            node->term = std::shared_ptr<ASTTerm>(term_node);
+            node->term = term_node;
         }
         return node;
-    } else if (_STR_EQ(n->name, "term")) {
-        auto node = new ASTTerm();
+    }
+    case NODE_TERM: {
+        auto node = create<ASTTerm>();
         if (n->children_num == 3) {
             auto term_node =
                 static_cast<ASTTerm *>(transform_node_iter(n->children[0]));
-            node->term = std::shared_ptr<ASTTerm>(term_node);
+            node->term = term_node;
 
-            auto op_name = n->children[1]->children[0]->name;
-            if (_STR_EQ(op_name, "*"))
+            auto op = n->children[1]->children[0]->kind;
+            if (op == MUL)
                 node->op = OP_MUL;
-            else if (_STR_EQ(op_name, "/"))
+            else if (op == DIV)
                 node->op = OP_DIV;
 
             auto factor_node =
                 static_cast<ASTFactor *>(transform_node_iter(n->children[2]));
-            node->factor = std::shared_ptr<ASTFactor>(factor_node);
+            node->factor = factor_node;
         } else {
             auto factor_node =
                 static_cast<ASTFactor *>(transform_node_iter(n->children[0]));
-            node->factor = std::shared_ptr<ASTFactor>(factor_node);
+            node->factor = factor_node;
         }
         return node;
-    } else if (_STR_EQ(n->name, "factor")) {
+    }
+    case NODE_FACTOR: {
         int i = 0;
         if (n->children_num == 3)
             i = 1;
-        auto name = n->children[i]->name;
-        if (_STR_EQ(name, "expression") || _STR_EQ(name, "var") ||
-            _STR_EQ(name, "call"))
+        auto kind = n->children[i]->kind;
+        if (kind == NODE_EXPRESSION || kind == NODE_VAR || kind == NODE_CALL)
             return transform_node_iter(n->children[i]);
         else {
-            auto num_node = new ASTNum();
-            if (_STR_EQ(name, "integer")) {
+            auto num_node = create<ASTNum>();
+            if (kind == NODE_INTEGER) {
                 num_node->type = TYPE_INT;
                 num_node->i_val = std::stoi(n->children[i]->children[0]->name);
-            } else if (_STR_EQ(name, "float")) {
+            } else if (kind == NODE_FLOAT) {
                 num_node->type = TYPE_FLOAT;
                 num_node->f_val = std::stof(n->children[i]->children[0]->name);
             } else {
@@ -335,11 +347,12 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
             }
             return num_node;
         }
-    } else if (_STR_EQ(n->name, "call")) {
-        auto node = new ASTCall();
-        node->id = n->children[0]->name;
+    }
+    case NODE_CALL: {
+        auto node = create<ASTCall>();
+        node->id = create_id(n->children[0]->name);
         // flatten args
-        if (_STR_EQ(n->children[2]->children[0]->name, "arg-list")) {
+        if (n->children[2]->children[0]->kind == NODE_ARG_LIST) {
             auto list_ptr = n->children[2]->children[0];
             auto s = std::stack<syntax_tree_node *>();
             while (list_ptr->children_num == 3) {
@@ -348,16 +361,18 @@ ASTNode *AST::transform_node_iter(syntax_tree_node *n) {
             }
             s.push(list_ptr->children[0]);
 
+            std::vector<ASTExpression *> args;
             while (!s.empty()) {
                 auto expr_node =
                     static_cast<ASTExpression *>(transform_node_iter(s.top()));
-                auto expr_node_ptr = std::shared_ptr<ASTExpression>(expr_node);
-                node->args.push_back(expr_node_ptr);
+                args.push_back(expr_node);
                 s.pop();
             }
+            node->args = create_list(args);
         }
         return node;
-    } else {
+    }
+    default:
         std::cerr << "[ast]: transform failure!" << std::endl;
         std::abort();
     }
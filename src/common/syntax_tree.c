@@ -3,48 +3,71 @@
 
 #include "syntax_tree.h"
 
-syntax_tree_node * new_syntax_tree_node(const char * name)
+struct _syntax_tree_chunk {
+	struct _syntax_tree_chunk * next;
+	char data[];
+};
+
+#define SYNTAX_TREE_CHUNK_SIZE (64 * 1024)
+
+static void * syntax_tree_alloc(syntax_tree * tree, size_t size)
 {
-	syntax_tree_node * new_node = (syntax_tree_node *)malloc(sizeof(syntax_tree_node));
-	if (name)
-		strncpy(new_node->name, name, SYNTAX_TREE_NODE_NAME_MAX);
-	else
-		new_node->name[0] = '\0';
-	new_node->children_num = 0;
-	return new_node;
+	// keep pointers aligned
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	if ((size_t)(tree->end - tree->cur) < size) {
+		size_t chunk_size = size > SYNTAX_TREE_CHUNK_SIZE ? size : SYNTAX_TREE_CHUNK_SIZE;
+		struct _syntax_tree_chunk * chunk = malloc(sizeof(struct _syntax_tree_chunk) + chunk_size);
+		if (!chunk) {
+			fprintf(stderr, "[ERR] Out of memory for the syntax tree.\n");
+			exit(1);
+		}
+		chunk->next = tree->chunks;
+		tree->chunks = chunk;
+		tree->cur = chunk->data;
+		tree->end = chunk->data + chunk_size;
+	}
+	void * p = tree->cur;
+	tree->cur += size;
+	return p;
 }
 
-int syntax_tree_add_child(syntax_tree_node * parent, syntax_tree_node * child)
+syntax_tree_node * new_syntax_tree_node(syntax_tree * tree, const char * name, int children_num)
 {
-	if (!parent || !child)	return -1;
-	parent->children[parent->children_num++] = child;
-	return parent->children_num;
+	syntax_tree_node * new_node = syntax_tree_alloc(tree, sizeof(syntax_tree_node));
+	new_node->children = children_num ? syntax_tree_alloc(tree, children_num * sizeof(syntax_tree_node *)) : NULL;
+	new_node->children_num = children_num;
+	new_node->name = name ? name : "";
+	new_node->kind = 0;
+	return new_node;
 }
 
-void del_syntax_tree_node(syntax_tree_node * node, int recursive)
+syntax_tree_node * new_syntax_tree_token(syntax_tree * tree, const char * text, int len)
 {
-	if (!node)	return;
-
-	int i;
-	if (recursive) {
-		for (i = 0; i < node->children_num; i++) {
-			del_syntax_tree_node(node->children[i], 1);
-		}
-	}
-	free(node);
+	char * name = syntax_tree_alloc(tree, len + 1);
+	memcpy(name, text, len);
+	name[len] = '\0';
+	return new_syntax_tree_node(tree, name, 0);
 }
 
 syntax_tree * new_syntax_tree()
 {
-	return (syntax_tree *)malloc(sizeof(syntax_tree));
+	syntax_tree * tree = (syntax_tree *)malloc(sizeof(syntax_tree));
+	tree->root = NULL;
+	tree->chunks = NULL;
+	tree->cur = tree->end = NULL;
+	return tree;
 }
 
 void del_syntax_tree(syntax_tree * tree)
 {
 	if (!tree)	return;
 
-	if (tree->root) {
-		del_syntax_tree_node(tree->root, 1);
+	// one free() per chunk, however deep the tree is
+	struct _syntax_tree_chunk * chunk = tree->chunks;
+	while (chunk) {
+		struct _syntax_tree_chunk * next = chunk->next;
+		free(chunk);
+		chunk = next;
 	}
 	free(tree);
 }
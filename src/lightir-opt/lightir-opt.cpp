@@ -0,0 +1,173 @@
+#include "Bitcode.hpp"
+#include "CodeGen.hpp"
+#include "DeadCode.hpp"
+#include "Dominators.hpp"
+#include "IRparser.hpp"
+#include "Mem2Reg.hpp"
+#include "Module.hpp"
+#include "PassManager.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::operator""s;
+
+// Load LightIR saved as .ll or .lirbc, run the passes given on the command
+// line in order, and write the result as IR, bitcode or assembly.
+struct Config {
+    enum class PassKind { Mem2Reg, DeadCode };
+
+    string exe_name;
+    std::filesystem::path input_file;
+    std::filesystem::path output_file{"-"}; // standard output by default
+
+    bool emitasm{false};
+    bool emitbc{false};
+    bool print_dom{false};
+    std::vector<PassKind> passes;
+
+    Config(int argc, char **argv) : argc(argc), argv(argv) {
+        parse_cmd_line();
+        check();
+    }
+
+    // print error message and exit
+    void print_err(const string &msg) const;
+
+  private:
+    int argc{-1};
+    char **argv{nullptr};
+
+    void parse_cmd_line();
+    void check();
+    // print helper infomation and exit
+    void print_help() const;
+};
+
+int main(int argc, char **argv) {
+    Config config(argc, argv);
+
+    string err;
+    std::unique_ptr<Module> m;
+    if (config.input_file.extension() == BITCODE_EXTENSION)
+        m = read_bitcode(config.input_file.string(), err);
+    else
+        m = parse_ir(config.input_file.string(), err);
+    if (not m)
+        config.print_err(err);
+
+    PassManager PM(m.get());
+    for (auto pass : config.passes) {
+        switch (pass) {
+        case Config::PassKind::Mem2Reg:
+            PM.add_pass<Mem2Reg>();
+            break;
+        case Config::PassKind::DeadCode:
+            PM.add_pass<DeadCode>();
+            break;
+        }
+    }
+    PM.run();
+
+    std::error_code ec;
+    llvm::raw_fd_ostream output_stream(config.output_file.string(), ec);
+    if (ec)
+        config.print_err(config.output_file.string() + ": " + ec.message());
+    output_stream.SetBufferSize(1 << 20);
+    if (config.print_dom) {
+        Dominators doms(m.get());
+        doms.run();
+        doms.print(output_stream);
+    } else if (config.emitasm) {
+        CodeGen codegen(m.get());
+        codegen.run();
+        codegen.print(output_stream);
+    } else if (config.emitbc) {
+        write_bitcode(m.get(), output_stream);
+    } else {
+        std::ostringstream source_filename;
+        source_filename << config.input_file;
+        output_stream << "; ModuleID = 'cminus'\n";
+        output_stream << "source_filename = " << source_filename.str()
+                      << "\n\n";
+        m->print(output_stream);
+    }
+
+    return 0;
+}
+
+void Config::parse_cmd_line() {
+    exe_name = argv[0];
+    bool has_output = false;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == "-h"s || argv[i] == "--help"s) {
+            print_help();
+        } else if (argv[i] == "-o"s) {
+            if (!has_output && i + 1 < argc) {
+                output_file = argv[i + 1];
+                has_output = true;
+                i += 1;
+            } else {
+                print_err("bad output file");
+            }
+        } else if (argv[i] == "-emit-llvm"s) {
+            // the default
+        } else if (argv[i] == "-emit-bc"s) {
+            emitbc = true;
+        } else if (argv[i] == "-S"s) {
+            emitasm = true;
+        } else if (argv[i] == "-mem2reg"s) {
+            passes.push_back(PassKind::Mem2Reg);
+        } else if (argv[i] == "-dce"s) {
+            passes.push_back(PassKind::DeadCode);
+        } else if (argv[i] == "-print-dom"s) {
+            print_dom = true;
+        } else if (input_file.empty() &&
+                   (argv[i][0] != '-' || argv[i] == "-"s)) {
+            input_file = argv[i];
+        } else {
+            string err =
+                "unrecognized command-line option \'"s + argv[i] + "\'"s;
+            print_err(err);
+        }
+    }
+}
+
+void Config::check() {
+    if (input_file.empty()) {
+        print_err("no input file");
+    }
+    if (input_file != "-" and input_file.extension() != IR_EXTENSION and
+        input_file.extension() != BITCODE_EXTENSION) {
+        print_err("file format not recognized");
+    }
+    if (emitasm and emitbc) {
+        print_err("emit asm and emit bitcode both set");
+    }
+    if (print_dom and (emitasm or emitbc)) {
+        print_err("print dominators and emit asm/bitcode both set");
+    }
+}
+
+void Config::print_help() const {
+    std::cout << "Usage: " << exe_name
+              << " [-h|--help] [-o <target-file>] [-mem2reg] [-dce] "
+                 "[-emit-llvm] [-emit-bc] [-S] [-print-dom] <input-file>\n"
+                 "Passes run in the order they are given. The input is a .ll "
+                 "or .lirbc file, or - for .ll on the standard input.\n"
+                 "-print-dom prints the dominator tree of the result instead "
+                 "of the module."
+              << std::endl;
+    exit(0);
+}
+
+void Config::print_err(const string &msg) const {
+    std::cout << exe_name << ": " << msg << std::endl;
+    exit(-1);
+}
@@ -3,18 +3,69 @@
 #include "IRprinter.hpp"
 #include "Module.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <llvm/Support/raw_ostream.h>
 
 BasicBlock::BasicBlock(Module *m, const std::string &name = "",
                        Function *parent = nullptr)
-    : Value(m->get_label_type(), name), parent_(parent) {
+    : Value(BasicBlockVal, m->get_label_type(), name), parent_(parent) {
     assert(parent && "currently parent should not be nullptr");
     parent_->add_basic_block(this);
 }
 
+BasicBlock *BasicBlock::create(Module *m, const std::string &name,
+                               Function *parent) {
+    auto prefix = name.empty() ? "" : "label_";
+    return new (m->get_arena().allocate<BasicBlock>())
+        BasicBlock(m, prefix + name, parent);
+}
+
+void llvm::ilist_alloc_traits<BasicBlock>::deleteNode(BasicBlock *bb) {
+    auto &arena = bb->get_module()->get_arena();
+    bb->~BasicBlock();
+    arena.deallocate(bb);
+}
+
 Module *BasicBlock::get_module() { return get_parent()->get_parent(); }
+
+void BasicBlock::add_edge(BasicBlock *from, BasicBlock *to) {
+    from->succ_bbs_.push_back(to);
+    to->pre_bbs_.push_back(from);
+    from->get_parent()->invalidate_cfg();
+}
+
+void BasicBlock::remove_edge(BasicBlock *from, BasicBlock *to) {
+    // drop a single edge: a cond br may jump to the same block twice
+    auto erase_one = [](BBList &list, BasicBlock *bb) {
+        auto iter = std::find(list.begin(), list.end(), bb);
+        if (iter != list.end())
+            list.erase(iter);
+    };
+    erase_one(from->succ_bbs_, to);
+    erase_one(to->pre_bbs_, from);
+    from->get_parent()->invalidate_cfg();
+}
+void BasicBlock::reorder_pre_basic_blocks(const BBList &preds) {
+    assert(std::is_permutation(preds.begin(), preds.end(), pre_bbs_.begin(),
+                               pre_bbs_.end()) &&
+           "not the same predecessors");
+    pre_bbs_ = preds;
+}
+
 void BasicBlock::erase_from_parent() { this->get_parent()->remove(this); }
 
+const std::string &BasicBlock::get_asm_label() {
+    if (asm_label_)
+        return *asm_label_;
+    auto label = get_module()->get_string_pool().intern(
+        "." + parent_->get_name() + "_" + get_name());
+    // an unnamed block may still be named later, so don't cache its label
+    if (not get_name().empty())
+        asm_label_ = label;
+    return *label;
+}
+
 bool BasicBlock::is_terminated() const {
     if (instr_list_.empty())
         return false;
@@ -36,33 +87,41 @@ Instruction *BasicBlock::get_terminator() {
 void BasicBlock::add_instruction(Instruction *instr) {
     assert(not is_terminated() && "Inserting instruction to terminated bb");
     instr_list_.push_back(instr);
+    if (not instr->is_void() and instr->get_name().empty())
+        mark_needs_numbering();
+}
+
+void BasicBlock::add_instr_begin(Instruction *instr) {
+    instr_list_.push_front(instr);
+    if (not instr->is_void() and instr->get_name().empty())
+        mark_needs_numbering();
+}
+
+void BasicBlock::mark_needs_numbering() {
+    needs_numbering_ = true;
+    parent_->mark_needs_numbering();
 }
 
-std::string BasicBlock::print() {
-    std::string bb_ir;
-    bb_ir += this->get_name();
-    bb_ir += ":";
+void BasicBlock::print(llvm::raw_ostream &os) {
+    os << this->get_name() << ':';
     // print prebb
     if (!this->get_pre_basic_blocks().empty()) {
-        bb_ir += "                                                ; preds = ";
+        os << "                                                ; preds = ";
     }
     for (auto bb : this->get_pre_basic_blocks()) {
         if (bb != *this->get_pre_basic_blocks().begin())
-            bb_ir += ", ";
-        bb_ir += print_as_op(bb, false);
+            os << ", ";
+        print_as_op(os, bb, false);
     }
 
     // print prebb
     if (!this->get_parent()) {
-        bb_ir += "\n";
-        bb_ir += "; Error: Block without parent!";
+        os << "\n; Error: Block without parent!";
     }
-    bb_ir += "\n";
+    os << '\n';
     for (auto &instr : this->get_instructions()) {
-        bb_ir += "  ";
-        bb_ir += instr.print();
-        bb_ir += "\n";
+        os << "  ";
+        instr.print(os);
+        os << '\n';
     }
-
-    return bb_ir;
 }
@@ -0,0 +1,643 @@
+#include "Bitcode.hpp"
+#include "BasicBlock.hpp"
+#include "Casting.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "Instruction.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SwapByteOrder.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace {
+
+constexpr uint32_t MAGIC = 0x4252494c; // "LIRB"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t LOCAL_REF = 1u << 31;
+constexpr uint32_t NULL_REF = ~0u;
+
+class BitcodeWriter {
+  public:
+    explicit BitcodeWriter(Module *m) : m_(m) {}
+
+    void write(llvm::raw_ostream &os);
+
+  private:
+    void write_function(Function &func);
+
+    // names are interned, so the address of a name identifies it
+    uint32_t get_string(const std::string &name);
+    uint32_t get_type(Type *ty);
+    uint32_t get_constant(Constant *c);
+    uint32_t get_ref(Value *v);
+
+    Module *m_;
+
+    llvm::DenseMap<const std::string *, uint32_t> string_ids_;
+    std::vector<const std::string *> strings_;
+    llvm::DenseMap<Type *, uint32_t> type_ids_;
+    std::vector<uint32_t> types_;
+    // functions, globals and constants
+    llvm::DenseMap<Value *, uint32_t> global_ids_;
+    uint32_t first_constant_{0};
+    uint32_t num_constants_{0};
+    std::vector<uint32_t> constants_;
+    std::vector<uint32_t> body_;
+
+    // the function being written, for local references
+    unsigned num_args_{0};
+    unsigned num_blocks_{0};
+};
+
+uint32_t BitcodeWriter::get_string(const std::string &name) {
+    auto [it, inserted] = string_ids_.try_emplace(&name, strings_.size());
+    if (inserted)
+        strings_.push_back(&name);
+    return it->second;
+}
+
+uint32_t BitcodeWriter::get_type(Type *ty) {
+    auto it = type_ids_.find(ty);
+    if (it != type_ids_.end())
+        return it->second;
+
+    // the types this one is built from are written first
+    std::vector<uint32_t> record{ty->get_type_id()};
+    switch (ty->get_type_id()) {
+    case Type::VoidTyID:
+    case Type::LabelTyID:
+    case Type::FloatTyID:
+        break;
+    case Type::IntegerTyID:
+        record.push_back(static_cast<IntegerType *>(ty)->get_num_bits());
+        break;
+    case Type::PointerTyID:
+        record.push_back(get_type(ty->get_pointer_element_type()));
+        break;
+    case Type::ArrayTyID: {
+        auto array_ty = static_cast<ArrayType *>(ty);
+        record.push_back(get_type(array_ty->get_element_type()));
+        record.push_back(array_ty->get_num_of_elements());
+        break;
+    }
+    case Type::FunctionTyID: {
+        auto func_ty = static_cast<FunctionType *>(ty);
+        record.push_back(get_type(func_ty->get_return_type()));
+        record.push_back(func_ty->get_num_of_args());
+        for (auto param : func_ty->get_params())
+            record.push_back(get_type(param));
+        break;
+    }
+    }
+    types_.insert(types_.end(), record.begin(), record.end());
+    auto id = type_ids_.size();
+    type_ids_[ty] = id;
+    return id;
+}
+
+uint32_t BitcodeWriter::get_constant(Constant *c) {
+    auto it = global_ids_.find(c);
+    if (it != global_ids_.end())
+        return it->second;
+
+    // array elements are written first
+    std::vector<uint32_t> record{c->get_value_id(), get_type(c->get_type())};
+    if (auto ci = dyn_cast<ConstantInt>(c)) {
+        record.push_back(static_cast<uint32_t>(ci->get_value()));
+    } else if (auto cf = dyn_cast<ConstantFP>(c)) {
+        float val = cf->get_value();
+        uint32_t bits;
+        std::memcpy(&bits, &val, sizeof(bits));
+        record.push_back(bits);
+    } else if (auto ca = dyn_cast<ConstantArray>(c)) {
+        record.push_back(ca->get_size_of_array());
+        for (unsigned i = 0; i < ca->get_size_of_array(); i++)
+            record.push_back(get_constant(ca->get_element_value(i)));
+    } else {
+        assert(isa<ConstantZero>(c) && "unknown constant");
+    }
+    constants_.insert(constants_.end(), record.begin(), record.end());
+    auto id = first_constant_ + num_constants_++;
+    global_ids_[c] = id;
+    return id;
+}
+
+uint32_t BitcodeWriter::get_ref(Value *v) {
+    if (v == nullptr)
+        return NULL_REF;
+    if (auto arg = dyn_cast<Argument>(v))
+        return LOCAL_REF | arg->get_arg_no();
+    if (auto bb = dyn_cast<BasicBlock>(v))
+        return LOCAL_REF | (num_args_ + bb->get_index());
+    if (auto instr = dyn_cast<Instruction>(v))
+        return LOCAL_REF | (num_args_ + num_blocks_ + instr->get_index());
+    if (auto c = dyn_cast<Constant>(v))
+        return get_constant(c);
+    assert(global_ids_.count(v) && "reference to a value of another module");
+    return global_ids_[v];
+}
+
+void BitcodeWriter::write_function(Function &func) {
+    if (func.is_declaration()) {
+        body_.push_back(0);
+        return;
+    }
+
+    func.renumber();
+    num_args_ = func.get_num_of_args();
+    num_blocks_ = func.get_num_block_indices();
+    body_.push_back(num_blocks_);
+    for (auto &arg : func.get_args())
+        body_.push_back(get_string(arg.get_name()));
+    for (auto &bb : func.get_basic_blocks()) {
+        body_.push_back(get_string(bb.get_name()));
+        body_.push_back(bb.get_num_of_instr());
+        // the order of predecessors depends on the order in which branches
+        // were created, which is not the layout order
+        body_.push_back(bb.get_pre_basic_blocks().size());
+        for (auto pred : bb.get_pre_basic_blocks())
+            body_.push_back(pred->get_index());
+    }
+
+    // result types first, so that the reader can stand in for instructions
+    // used before they are defined
+    body_.push_back(func.get_num_instr_indices());
+    for (auto &bb : func.get_basic_blocks())
+        for (auto &instr : bb.get_instructions())
+            body_.push_back(get_type(instr.get_type()));
+
+    for (auto &bb : func.get_basic_blocks()) {
+        for (auto &instr : bb.get_instructions()) {
+            body_.push_back(instr.get_instr_type());
+            body_.push_back(get_string(instr.get_name()));
+            body_.push_back(instr.get_num_operand());
+            for (auto op : instr.get_operands())
+                body_.push_back(get_ref(op));
+        }
+    }
+}
+
+void BitcodeWriter::write(llvm::raw_ostream &os) {
+    uint32_t num_functions = 0, num_globals = 0;
+    for (auto &func : m_->get_functions())
+        global_ids_[&func] = num_functions++;
+    for (auto &global : m_->get_global_variable())
+        global_ids_[&global] = num_functions + num_globals++;
+    first_constant_ = num_functions + num_globals;
+
+    for (auto &func : m_->get_functions()) {
+        body_.push_back(get_string(func.get_name()));
+        body_.push_back(get_type(func.get_function_type()));
+    }
+    for (auto &global : m_->get_global_variable()) {
+        auto elem_ty = global.get_type()->get_pointer_element_type();
+        body_.push_back(get_string(global.get_name()));
+        body_.push_back(get_type(elem_ty));
+        body_.push_back(global.is_const());
+        body_.push_back(get_ref(global.get_init()));
+    }
+    for (auto &func : m_->get_functions())
+        write_function(func);
+
+    auto write_words = [&os](std::vector<uint32_t> &words) {
+        if (llvm::sys::IsBigEndianHost)
+            for (auto &word : words)
+                llvm::sys::swapByteOrder(word);
+        os.write(reinterpret_cast<const char *>(words.data()),
+                 words.size() * sizeof(uint32_t));
+    };
+
+    std::vector<uint32_t> header{MAGIC,
+                                 VERSION,
+                                 static_cast<uint32_t>(strings_.size()),
+                                 static_cast<uint32_t>(type_ids_.size()),
+                                 num_constants_,
+                                 num_functions,
+                                 num_globals};
+    write_words(header);
+    for (auto str : strings_) {
+        std::vector<uint32_t> len{static_cast<uint32_t>(str->size())};
+        write_words(len);
+        os << *str;
+        // keep the following words aligned
+        os.write_zeros(-str->size() & 3);
+    }
+    write_words(types_);
+    write_words(constants_);
+    write_words(body_);
+}
+
+class BitcodeReader {
+  public:
+    explicit BitcodeReader(llvm::StringRef buffer)
+        : cur_(buffer.bytes_begin()), end_(buffer.bytes_end()) {}
+
+    std::unique_ptr<Module> read(std::string &err);
+
+  private:
+    bool read_strings(uint32_t count);
+    bool read_types(uint32_t count);
+    bool read_constants(uint32_t first, uint32_t count);
+    bool read_body(Function *func);
+
+    // next word of the stream, 0 once the stream is exhausted
+    uint32_t next() {
+        if (end_ - cur_ < 4) {
+            error("unexpected end of file");
+            cur_ = end_;
+            return 0;
+        }
+        auto word = llvm::support::endian::read32le(cur_);
+        cur_ += 4;
+        return word;
+    }
+    // whether count more words can still be read
+    bool has_words(uint64_t count) {
+        if (count * 4 <= static_cast<uint64_t>(end_ - cur_))
+            return true;
+        return error("unexpected end of file");
+    }
+    bool error(const std::string &msg) {
+        if (err_.empty())
+            err_ = msg;
+        return false;
+    }
+
+    StringPool::Handle get_string(uint32_t id);
+    Type *get_type(uint32_t id);
+    Value *get_value(uint32_t ref);
+
+    const unsigned char *cur_;
+    const unsigned char *end_;
+    std::string err_;
+
+    Module *m_{nullptr};
+    std::vector<StringPool::Handle> strings_;
+    std::vector<Type *> types_;
+    std::vector<Value *> globals_;
+
+    // the function being read
+    std::vector<Value *> locals_;
+    unsigned first_instr_{0};
+    std::vector<Type *> instr_types_;
+    // stand-ins for instructions used before they are defined
+    std::vector<std::unique_ptr<Argument>> forward_refs_;
+    std::vector<Value *> operands_;
+};
+
+StringPool::Handle BitcodeReader::get_string(uint32_t id) {
+    if (id < strings_.size())
+        return strings_[id];
+    error("invalid string index");
+    return m_->get_string_pool().empty();
+}
+
+Type *BitcodeReader::get_type(uint32_t id) {
+    if (id < types_.size())
+        return types_[id];
+    error("invalid type index");
+    return nullptr;
+}
+
+Value *BitcodeReader::get_value(uint32_t ref) {
+    if (ref == NULL_REF)
+        return nullptr;
+    if (not(ref & LOCAL_REF)) {
+        if (ref < globals_.size() and globals_[ref])
+            return globals_[ref];
+        error("invalid value reference");
+        return nullptr;
+    }
+
+    auto idx = ref & ~LOCAL_REF;
+    if (idx >= locals_.size()) {
+        error("invalid value reference");
+        return nullptr;
+    }
+    if (locals_[idx])
+        return locals_[idx];
+    auto &forward_ref = forward_refs_[idx - first_instr_];
+    if (not forward_ref)
+        forward_ref =
+            std::make_unique<Argument>(instr_types_[idx - first_instr_]);
+    return forward_ref.get();
+}
+
+bool BitcodeReader::read_strings(uint32_t count) {
+    if (not has_words(count))
+        return false;
+    strings_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        auto len = next();
+        auto padded = (static_cast<uint64_t>(len) + 3) & ~uint64_t(3);
+        if (not has_words(padded / 4))
+            return false;
+        // the only copy is the one kept in the string pool
+        auto str = reinterpret_cast<const char *>(cur_);
+        strings_.push_back(
+            m_->get_string_pool().intern(std::string(str, str + len)));
+        cur_ += padded;
+    }
+    return err_.empty();
+}
+
+bool BitcodeReader::read_types(uint32_t count) {
+    if (not has_words(count))
+        return false;
+    types_.reserve(count);
+    for (uint32_t i = 0; i < count and err_.empty(); i++) {
+        Type *ty = nullptr;
+        switch (next()) {
+        case Type::VoidTyID:
+            ty = m_->get_void_type();
+            break;
+        case Type::LabelTyID:
+            ty = m_->get_label_type();
+            break;
+        case Type::FloatTyID:
+            ty = m_->get_float_type();
+            break;
+        case Type::IntegerTyID: {
+            auto bits = next();
+            if (bits == 1)
+                ty = m_->get_int1_type();
+            else if (bits == 32)
+                ty = m_->get_int32_type();
+            break;
+        }
+        case Type::PointerTyID:
+            if (auto elem = get_type(next());
+                elem and PointerType::is_valid_element_type(elem))
+                ty = m_->get_pointer_type(elem);
+            break;
+        case Type::ArrayTyID: {
+            auto elem = get_type(next());
+            auto num = next();
+            if (elem and ArrayType::is_valid_element_type(elem))
+                ty = m_->get_array_type(elem, num);
+            break;
+        }
+        case Type::FunctionTyID: {
+            auto result = get_type(next());
+            auto num_params = next();
+            if (not has_words(num_params))
+                return false;
+            std::vector<Type *> params;
+            bool valid =
+                result and FunctionType::is_valid_return_type(result);
+            for (uint32_t j = 0; j < num_params; j++) {
+                params.push_back(get_type(next()));
+                valid = valid and params.back() and
+                        FunctionType::is_valid_argument_type(params.back());
+            }
+            if (err_.empty() and valid)
+                ty = m_->get_function_type(result, params);
+            break;
+        }
+        }
+        if (ty == nullptr)
+            return error("invalid type record");
+        types_.push_back(ty);
+    }
+    return err_.empty();
+}
+
+bool BitcodeReader::read_constants(uint32_t first, uint32_t count) {
+    if (not has_words(count))
+        return false;
+    for (uint32_t i = 0; i < count and err_.empty(); i++) {
+        auto vid = next();
+        auto ty = get_type(next());
+        if (ty == nullptr)
+            return false;
+        Constant *c = nullptr;
+        switch (vid) {
+        case Value::ConstantIntVal: {
+            auto val = static_cast<int>(next());
+            if (ty == m_->get_int1_type())
+                c = ConstantInt::get(val != 0, m_);
+            else if (ty == m_->get_int32_type())
+                c = ConstantInt::get(val, m_);
+            break;
+        }
+        case Value::ConstantFPVal: {
+            auto bits = next();
+            float val;
+            std::memcpy(&val, &bits, sizeof(val));
+            if (ty->is_float_type())
+                c = ConstantFP::get(val, m_);
+            break;
+        }
+        case Value::ConstantZeroVal:
+            c = ConstantZero::get(ty, m_);
+            break;
+        case Value::ConstantArrayVal: {
+            auto size = next();
+            if (not ty->is_array_type() or
+                size != static_cast<ArrayType *>(ty)->get_num_of_elements() or
+                not has_words(size))
+                break;
+            std::vector<Constant *> elems;
+            elems.reserve(size);
+            for (uint32_t j = 0; j < size; j++) {
+                auto elem = dyn_cast_or_null<Constant>(get_value(next()));
+                if (elem == nullptr)
+                    return error("invalid constant array element");
+                elems.push_back(elem);
+            }
+            c = ConstantArray::get(static_cast<ArrayType *>(ty), elems);
+            break;
+        }
+        }
+        if (c == nullptr)
+            return error("invalid constant record");
+        globals_[first + i] = c;
+    }
+    return err_.empty();
+}
+
+bool BitcodeReader::read_body(Function *func) {
+    auto num_blocks = next();
+    if (num_blocks == 0)
+        return err_.empty();
+
+    locals_.clear();
+    for (auto &arg : func->get_args()) {
+        arg.set_name(*get_string(next()));
+        func->reserve_name(arg.get_name());
+        locals_.push_back(&arg);
+    }
+    if (not has_words(uint64_t(num_blocks) * 3))
+        return false;
+    std::vector<uint32_t> block_sizes;
+    std::vector<std::vector<uint32_t>> block_preds(num_blocks);
+    block_sizes.reserve(num_blocks);
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        // create() would prefix the saved name again
+        auto bb = BasicBlock::create(m_, "", func);
+        bb->set_name(*get_string(next()));
+        func->reserve_name(bb->get_name());
+        locals_.push_back(bb);
+        block_sizes.push_back(next());
+        auto num_preds = next();
+        if (not has_words(num_preds))
+            return false;
+        for (uint32_t j = 0; j < num_preds; j++)
+            block_preds[i].push_back(next());
+    }
+
+    auto num_instrs = next();
+    if (not has_words(num_instrs))
+        return false;
+    first_instr_ = locals_.size();
+    instr_types_.clear();
+    for (uint32_t i = 0; i < num_instrs; i++)
+        instr_types_.push_back(get_type(next()));
+    if (not err_.empty())
+        return false;
+    locals_.resize(first_instr_ + num_instrs, nullptr);
+    forward_refs_.clear();
+    forward_refs_.resize(num_instrs);
+
+    auto first_block = func->get_num_of_args();
+    uint32_t idx = 0;
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        auto bb = cast<BasicBlock>(locals_[first_block + i]);
+        for (uint32_t j = 0; j < block_sizes[i]; j++, idx++) {
+            if (idx >= num_instrs)
+                return error("instruction count mismatch");
+            auto op = next();
+            auto name = get_string(next());
+            auto num_ops = next();
+            if (not has_words(num_ops))
+                return false;
+            operands_.clear();
+            for (uint32_t k = 0; k < num_ops; k++)
+                operands_.push_back(get_value(next()));
+            if (not err_.empty())
+                return false;
+
+            if (bb->is_terminated())
+                return error("instruction after a terminator");
+            if (op > Instruction::sitofp)
+                return error("invalid opcode");
+            auto instr =
+                Instruction::create(static_cast<Instruction::OpID>(op),
+                                    instr_types_[idx], operands_, bb);
+            if (instr == nullptr or instr->get_type() != instr_types_[idx])
+                return error("invalid instruction record");
+            if (not name->empty()) {
+                instr->set_name(*name);
+                func->reserve_name(*name);
+            }
+            locals_[first_instr_ + idx] = instr;
+            if (auto &forward_ref = forward_refs_[idx]) {
+                forward_ref->replace_all_use_with(instr);
+                forward_ref.reset();
+            }
+        }
+    }
+    if (idx != num_instrs)
+        return error("instruction count mismatch");
+
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        auto bb = cast<BasicBlock>(locals_[first_block + i]);
+        BasicBlock::BBList preds;
+        for (auto pred : block_preds[i]) {
+            if (pred >= num_blocks)
+                return error("invalid predecessor");
+            preds.push_back(cast<BasicBlock>(locals_[first_block + pred]));
+        }
+        if (not std::is_permutation(preds.begin(), preds.end(),
+                                    bb->get_pre_basic_blocks().begin(),
+                                    bb->get_pre_basic_blocks().end()))
+            return error("predecessors do not match the branches");
+        bb->reorder_pre_basic_blocks(preds);
+    }
+    return err_.empty();
+}
+
+std::unique_ptr<Module> BitcodeReader::read(std::string &err) {
+    auto module = std::make_unique<Module>();
+    m_ = module.get();
+
+    if (next() != MAGIC or next() != VERSION) {
+        err = "not a LightIR bitcode file";
+        return nullptr;
+    }
+    auto num_strings = next();
+    auto num_types = next();
+    auto num_constants = next();
+    auto num_functions = next();
+    auto num_globals = next();
+    if (not has_words(uint64_t(num_functions) * 2 + uint64_t(num_globals) * 4 +
+                      num_constants)) {
+        err = err_;
+        return nullptr;
+    }
+    globals_.assign(num_functions + num_globals + num_constants, nullptr);
+
+    if (read_strings(num_strings) and read_types(num_types) and
+        read_constants(num_functions + num_globals, num_constants)) {
+        for (uint32_t i = 0; i < num_functions and err_.empty(); i++) {
+            auto name = get_string(next());
+            auto ty = get_type(next());
+            if (ty == nullptr or not ty->is_function_type()) {
+                error("invalid function record");
+                break;
+            }
+            globals_[i] =
+                Function::create(static_cast<FunctionType *>(ty), *name, m_);
+        }
+        for (uint32_t i = 0; i < num_globals and err_.empty(); i++) {
+            auto name = get_string(next());
+            auto ty = get_type(next());
+            bool is_const = next();
+            auto init = get_value(next());
+            if (ty == nullptr or not PointerType::is_valid_element_type(ty) or
+                init == nullptr or not isa<Constant>(init) or
+                init->get_type() != ty) {
+                error("invalid global variable record");
+                break;
+            }
+            globals_[num_functions + i] = GlobalVariable::create(
+                *name, m_, ty, is_const, static_cast<Constant *>(init));
+        }
+        for (auto &func : m_->get_functions())
+            if (err_.empty())
+                read_body(&func);
+    }
+    if (err_.empty() and cur_ != end_)
+        error("trailing data");
+
+    // drop stand-ins left by a failed read before the module goes away
+    forward_refs_.clear();
+    if (not err_.empty()) {
+        err = err_;
+        return nullptr;
+    }
+    return module;
+}
+
+} // namespace
+
+void write_bitcode(Module *m, llvm::raw_ostream &os) {
+    BitcodeWriter(m).write(os);
+}
+
+std::unique_ptr<Module> read_bitcode(const std::string &path,
+                                     std::string &err) {
+    // large files are mapped rather than copied into memory
+    auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (auto ec = buffer.getError()) {
+        err = path + ": " + ec.message();
+        return nullptr;
+    }
+    return BitcodeReader((*buffer)->getBuffer()).read(err);
+}
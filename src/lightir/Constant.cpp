@@ -1,64 +1,39 @@
 #include "Constant.hpp"
 #include "Module.hpp"
 
-#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <llvm/Support/raw_ostream.h>
 #include <memory>
-#include <sstream>
-#include <unordered_map>
-
-struct pair_hash {
-    template <typename T>
-    std::size_t operator()(const std::pair<T, Module *> val) const {
-        auto lhs = std::hash<T>()(val.first);
-        auto rhs =
-            std::hash<uintptr_t>()(reinterpret_cast<uintptr_t>(val.second));
-        return lhs ^ rhs;
-    }
-};
-
-static std::unordered_map<std::pair<int, Module *>,
-                          std::unique_ptr<ConstantInt>, pair_hash>
-    cached_int;
-static std::unordered_map<std::pair<bool, Module *>,
-                          std::unique_ptr<ConstantInt>, pair_hash>
-    cached_bool;
-static std::unordered_map<std::pair<float, Module *>,
-                          std::unique_ptr<ConstantFP>, pair_hash>
-    cached_float;
-static std::unordered_map<Type *, std::unique_ptr<ConstantZero>> cached_zero;
 
 ConstantInt *ConstantInt::get(int val, Module *m) {
-    if (cached_int.find(std::make_pair(val, m)) != cached_int.end())
-        return cached_int[std::make_pair(val, m)].get();
-    return (cached_int[std::make_pair(val, m)] = std::unique_ptr<ConstantInt>(
-                new ConstantInt(m->get_int32_type(), val)))
-        .get();
+    auto &slot = m->int_consts_[val];
+    if (not slot)
+        slot.reset(new ConstantInt(m->get_int32_type(), val));
+    return slot.get();
 }
 ConstantInt *ConstantInt::get(bool val, Module *m) {
-    if (cached_bool.find(std::make_pair(val, m)) != cached_bool.end())
-        return cached_bool[std::make_pair(val, m)].get();
-    return (cached_bool[std::make_pair(val, m)] = std::unique_ptr<ConstantInt>(
-                new ConstantInt(m->get_int1_type(), val ? 1 : 0)))
-        .get();
+    auto &slot = m->bool_consts_[val ? 1 : 0];
+    if (not slot)
+        slot.reset(new ConstantInt(m->get_int1_type(), val ? 1 : 0));
+    return slot.get();
 }
-std::string ConstantInt::print() {
-    std::string const_ir;
+void ConstantInt::print(llvm::raw_ostream &os) {
     Type *ty = this->get_type();
     if (ty->is_integer_type() &&
         static_cast<IntegerType *>(ty)->get_num_bits() == 1) {
         // int1
-        const_ir += (this->get_value() == 0) ? "false" : "true";
+        os << ((this->get_value() == 0) ? "false" : "true");
     } else {
         // int32
-        const_ir += std::to_string(this->get_value());
+        os << this->get_value();
     }
-    return const_ir;
 }
 
 ConstantArray::ConstantArray(ArrayType *ty, const std::vector<Constant *> &val)
-    : Constant(ty, "") {
+    : Constant(ConstantArrayVal, ty, "") {
     for (unsigned i = 0; i < val.size(); i++)
-        set_operand(i, val[i]);
+        add_operand(val[i]);
     this->const_array.assign(val.begin(), val.end());
 }
 
@@ -68,49 +43,53 @@ Constant *ConstantArray::get_element_value(int index) {
 
 ConstantArray *ConstantArray::get(ArrayType *ty,
                                   const std::vector<Constant *> &val) {
-    return new ConstantArray(ty, val);
+    auto m = ty->get_module();
+    auto &slot = m->array_consts_[{ty, val}];
+    if (not slot)
+        slot.reset(new ConstantArray(ty, val));
+    return slot.get();
 }
 
-std::string ConstantArray::print() {
-    std::string const_ir;
-    const_ir += this->get_type()->print();
-    const_ir += " ";
-    const_ir += "[";
+void ConstantArray::print(llvm::raw_ostream &os) {
+    // "[ty elem, ty elem]", the type of the array itself is printed by the
+    // user, as for any other constant
+    os << '[';
     for (unsigned i = 0; i < this->get_size_of_array(); i++) {
         Constant *element = get_element_value(i);
-        if (!dynamic_cast<ConstantArray *>(get_element_value(i))) {
-            const_ir += element->get_type()->print();
-        }
-        const_ir += element->print();
-        if (i < this->get_size_of_array()) {
-            const_ir += ", ";
-        }
+        if (i > 0)
+            os << ", ";
+        element->get_type()->print(os);
+        os << ' ';
+        element->print(os);
     }
-    const_ir += "]";
-    return const_ir;
+    os << ']';
 }
 
 ConstantFP *ConstantFP::get(float val, Module *m) {
-    if (cached_float.find(std::make_pair(val, m)) != cached_float.end())
-        return cached_float[std::make_pair(val, m)].get();
-    return (cached_float[std::make_pair(val, m)] = std::unique_ptr<ConstantFP>(
-                new ConstantFP(m->get_float_type(), val)))
-        .get();
+    // unique by bit pattern, so that 0.0 and -0.0 stay different constants
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    auto &slot = m->float_consts_[bits];
+    if (not slot)
+        slot.reset(new ConstantFP(m->get_float_type(), val));
+    return slot.get();
 }
 
-std::string ConstantFP::print() {
-    std::stringstream fp_ir_ss;
-    std::string fp_ir;
+void ConstantFP::print(llvm::raw_ostream &os) {
+    // LLVM IR writes float constants as the bits of the equivalent double
     double val = this->get_value();
-    fp_ir_ss << "0x" << std::hex << *(uint64_t *)&val << std::endl;
-    fp_ir_ss >> fp_ir;
-    return fp_ir;
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    os << "0x";
+    os.write_hex(bits);
 }
 
 ConstantZero *ConstantZero::get(Type *ty, Module *m) {
-    if (not cached_zero[ty])
-        cached_zero[ty] = std::unique_ptr<ConstantZero>(new ConstantZero(ty));
-    return cached_zero[ty].get();
+    assert(ty->get_module() == m && "ConstantZero: type of another module");
+    auto &slot = m->zero_consts_[ty];
+    if (not slot)
+        slot.reset(new ConstantZero(ty));
+    return slot.get();
 }
 
-std::string ConstantZero::print() { return "zeroinitializer"; }
+void ConstantZero::print(llvm::raw_ostream &os) { os << "zeroinitializer"; }
@@ -2,18 +2,39 @@
 #include "IRprinter.hpp"
 #include "Module.hpp"
 
+#include <algorithm>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <unordered_set>
+
 Function::Function(FunctionType *ty, const std::string &name, Module *parent)
-    : Value(ty, name), parent_(parent), seq_cnt_(0) {
+    : Value(FunctionVal, ty, name), parent_(parent), seq_cnt_(0) {
     // num_args_ = ty->getNumParams();
     parent->add_function(this);
     // build args
     for (unsigned i = 0; i < get_num_of_args(); i++) {
         arguments_.emplace_back(ty->get_param_type(i), "", this, i);
     }
+    needs_numbering_ = not arguments_.empty();
+}
+Function::~Function() {
+    // Blocks are destroyed in list order, so first drop all references
+    // between instructions: no branch or phi may see a dead block
+    for (auto &bb : basic_blocks_)
+        for (auto &instr : bb.get_instructions())
+            instr.remove_all_operands();
 }
+
 Function *Function::create(FunctionType *ty, const std::string &name,
                            Module *parent) {
-    return new Function(ty, name, parent);
+    return new (parent->get_arena().allocate<Function>())
+        Function(ty, name, parent);
+}
+
+void llvm::ilist_alloc_traits<Function>::deleteNode(Function *func) {
+    auto &arena = func->get_parent()->get_arena();
+    func->~Function();
+    arena.deallocate(func);
 }
 
 FunctionType *Function::get_function_type() const {
@@ -35,97 +56,131 @@ Module *Function::get_parent() const { return parent_; }
 void Function::remove(BasicBlock *bb) {
     basic_blocks_.remove(bb);
     for (auto pre : bb->get_pre_basic_blocks()) {
-        pre->remove_succ_basic_block(bb);
+        auto &succs = pre->succ_bbs_;
+        succs.erase(std::remove(succs.begin(), succs.end(), bb), succs.end());
     }
     for (auto succ : bb->get_succ_basic_blocks()) {
-        succ->remove_pre_basic_block(bb);
+        auto &pres = succ->pre_bbs_;
+        pres.erase(std::remove(pres.begin(), pres.end(), bb), pres.end());
     }
+    invalidate_cfg();
 }
 
-void Function::add_basic_block(BasicBlock *bb) { basic_blocks_.push_back(bb); }
+void Function::add_basic_block(BasicBlock *bb) {
+    basic_blocks_.push_back(bb);
+    invalidate_cfg();
+    if (bb->get_name().empty())
+        bb->mark_needs_numbering();
+}
 
 void Function::set_instr_name() {
-    std::map<Value *, int> seq;
-    for (auto &arg : this->get_args()) {
-        if (seq.find(&arg) == seq.end()) {
-            auto seq_num = seq.size() + seq_cnt_;
-            if (arg.set_name("arg" + std::to_string(seq_num))) {
-                seq.insert({&arg, seq_num});
-            }
+    if (not needs_numbering_)
+        return;
+    // set_name() only succeeds on values that have no name yet
+    auto number = [&](Value &val, const char *prefix) {
+        if (val.set_name(prefix + std::to_string(seq_cnt_)))
+            seq_cnt_++;
+    };
+    for (auto &arg : this->get_args())
+        number(arg, "arg");
+    for (auto &bb : basic_blocks_) {
+        if (not bb.needs_numbering())
+            continue;
+        number(bb, "label");
+        for (auto &instr : bb.get_instructions()) {
+            if (!instr.is_void())
+                number(instr, "op");
         }
+        bb.clear_needs_numbering();
     }
-    for (auto &bb1 : basic_blocks_) {
-        auto bb = &bb1;
-        if (seq.find(bb) == seq.end()) {
-            auto seq_num = seq.size() + seq_cnt_;
-            if (bb->set_name("label" + std::to_string(seq_num))) {
-                seq.insert({bb, seq_num});
-            }
-        }
-        for (auto &instr : bb->get_instructions()) {
-            if (!instr.is_void() && seq.find(&instr) == seq.end()) {
-                auto seq_num = seq.size() + seq_cnt_;
-                if (instr.set_name("op" + std::to_string(seq_num))) {
-                    seq.insert({&instr, seq_num});
-                }
+    needs_numbering_ = false;
+}
+
+void Function::reserve_name(const std::string &name) {
+    for (auto prefix : {"op", "arg", "label"}) {
+        llvm::StringRef rest(name);
+        unsigned number;
+        // getAsInteger() fails unless all of rest is a number
+        if (rest.consume_front(prefix) and not rest.getAsInteger(10, number))
+            seq_cnt_ = std::max(seq_cnt_, number + 1);
+    }
+}
+
+const std::vector<BasicBlock *> &Function::get_reverse_post_order() {
+    if (rpo_valid_)
+        return rpo_;
+    rpo_.clear();
+    if (not is_declaration()) {
+        // iterative DFS: (block, index of the next successor to visit)
+        std::unordered_set<BasicBlock *> visited;
+        std::vector<std::pair<BasicBlock *, unsigned>> stack;
+        visited.insert(get_entry_block());
+        stack.emplace_back(get_entry_block(), 0);
+        while (not stack.empty()) {
+            auto &[bb, next] = stack.back();
+            auto &succs = bb->get_succ_basic_blocks();
+            if (next < succs.size()) {
+                auto succ = succs[next++];
+                if (visited.insert(succ).second)
+                    stack.emplace_back(succ, 0);
+            } else {
+                rpo_.push_back(bb);
+                stack.pop_back();
             }
         }
+        std::reverse(rpo_.begin(), rpo_.end());
     }
-    seq_cnt_ += seq.size();
+    rpo_valid_ = true;
+    return rpo_;
 }
 
-std::string Function::print() {
-    set_instr_name();
-    std::string func_ir;
-    if (this->is_declaration()) {
-        func_ir += "declare ";
-    } else {
-        func_ir += "define ";
+void Function::renumber() {
+    unsigned bb_idx = 0, instr_idx = 0;
+    for (auto &bb : basic_blocks_) {
+        bb.index_ = bb_idx++;
+        for (auto &instr : bb.get_instructions())
+            instr.index_ = instr_idx++;
     }
+    num_block_indices_ = bb_idx;
+    num_instr_indices_ = instr_idx;
+}
 
-    func_ir += this->get_return_type()->print();
-    func_ir += " ";
-    func_ir += print_as_op(this, false);
-    func_ir += "(";
+void Function::print(llvm::raw_ostream &os) {
+    set_instr_name();
+    os << (this->is_declaration() ? "declare " : "define ");
+    this->get_return_type()->print(os);
+    os << ' ';
+    print_as_op(os, this, false);
+    os << '(';
 
     // print arg
     if (this->is_declaration()) {
         for (unsigned i = 0; i < this->get_num_of_args(); i++) {
             if (i)
-                func_ir += ", ";
-            func_ir += static_cast<FunctionType *>(this->get_type())
-                           ->get_param_type(i)
-                           ->print();
+                os << ", ";
+            get_function_type()->get_param_type(i)->print(os);
         }
     } else {
         for (auto &arg : get_args()) {
             if (&arg != &*get_args().begin())
-                func_ir += ", ";
-            func_ir += arg.print();
+                os << ", ";
+            arg.print(os);
         }
     }
-    func_ir += ")";
+    os << ')';
 
     // print bb
     if (this->is_declaration()) {
-        func_ir += "\n";
+        os << '\n';
     } else {
-        func_ir += " {";
-        func_ir += "\n";
-        for (auto &bb1 : this->get_basic_blocks()) {
-            auto bb = &bb1;
-            func_ir += bb->print();
-        }
-        func_ir += "}";
+        os << " {\n";
+        for (auto &bb : this->get_basic_blocks())
+            bb.print(os);
+        os << '}';
     }
-
-    return func_ir;
 }
 
-std::string Argument::print() {
-    std::string arg_ir;
-    arg_ir += this->get_type()->print();
-    arg_ir += " %";
-    arg_ir += this->get_name();
-    return arg_ir;
+void Argument::print(llvm::raw_ostream &os) {
+    this->get_type()->print(os);
+    os << " %" << this->get_name();
 }
@@ -1,9 +1,11 @@
 #include "GlobalVariable.hpp"
 #include "IRprinter.hpp"
 
+#include <llvm/Support/raw_ostream.h>
+
 GlobalVariable::GlobalVariable(std::string name, Module *m, Type *ty,
                                bool is_const, Constant *init)
-    : User(ty, name), is_const_(is_const), init_val_(init) {
+    : User(GlobalVariableVal, ty, name), is_const_(is_const), init_val_(init), parent_(m) {
     m->add_global_variable(this);
     if (init) {
         this->add_operand(init);
@@ -13,16 +15,20 @@ GlobalVariable::GlobalVariable(std::string name, Module *m, Type *ty,
 GlobalVariable *GlobalVariable::create(std::string name, Module *m, Type *ty,
                                        bool is_const,
                                        Constant *init = nullptr) {
-    return new GlobalVariable(name, m, PointerType::get(ty), is_const, init);
+    return new (m->get_arena().allocate<GlobalVariable>())
+        GlobalVariable(name, m, PointerType::get(ty), is_const, init);
+}
+
+void llvm::ilist_alloc_traits<GlobalVariable>::deleteNode(GlobalVariable *gv) {
+    auto &arena = gv->get_parent()->get_arena();
+    gv->~GlobalVariable();
+    arena.deallocate(gv);
 }
 
-std::string GlobalVariable::print() {
-    std::string global_val_ir;
-    global_val_ir += print_as_op(this, false);
-    global_val_ir += " = ";
-    global_val_ir += (this->is_const() ? "constant " : "global ");
-    global_val_ir += this->get_type()->get_pointer_element_type()->print();
-    global_val_ir += " ";
-    global_val_ir += this->get_init()->print();
-    return global_val_ir;
+void GlobalVariable::print(llvm::raw_ostream &os) {
+    print_as_op(os, this, false);
+    os << " = " << (this->is_const() ? "constant " : "global ");
+    this->get_type()->get_pointer_element_type()->print(os);
+    os << ' ';
+    this->get_init()->print(os);
 }
@@ -0,0 +1,824 @@
+#include "IRparser.hpp"
+#include "BasicBlock.hpp"
+#include "Casting.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "IRprinter.hpp"
+#include "Instruction.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace {
+
+struct Token {
+    enum Kind { Eof, Word, LocalName, GlobalName, Int, Hex, String, Punct };
+
+    Kind kind{Eof};
+    // without the sigil of a name, the "0x" of a hex number or the quotes
+    llvm::StringRef text;
+    unsigned line{1};
+    unsigned col{1};
+
+    bool is(char c) const { return kind == Punct and text[0] == c; }
+    bool is_word(llvm::StringRef word) const {
+        return kind == Word and text == word;
+    }
+};
+
+bool is_name_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) or c == '_' or
+           c == '.' or c == '$';
+}
+bool is_digit(char c) { return std::isdigit(static_cast<unsigned char>(c)); }
+bool is_hex_digit(char c) {
+    return std::isxdigit(static_cast<unsigned char>(c));
+}
+
+std::string type_str(Type *ty) {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    ty->print(os);
+    return os.str();
+}
+
+// Look the opcode up by the name the printer gives it
+bool find_op(llvm::StringRef name, Instruction::OpID first,
+             Instruction::OpID last, Instruction::OpID &id) {
+    for (auto op = first; op <= last;
+         op = static_cast<Instruction::OpID>(op + 1)) {
+        if (name == print_instr_op_name(op)) {
+            id = op;
+            return true;
+        }
+    }
+    return false;
+}
+
+class IRParser {
+  public:
+    explicit IRParser(llvm::StringRef text)
+        : cur_(text.begin()), end_(text.end()), line_start_(text.begin()) {}
+
+    std::unique_ptr<Module> parse(std::string &err);
+
+  private:
+    // Position in the input, to look ahead or to come back to a body later
+    struct LexState {
+        const char *cur;
+        const char *line_start;
+        unsigned line;
+        Token tok;
+    };
+
+    void lex();
+    Token peek();
+    LexState save() const { return {cur_, line_start_, line_, tok_}; }
+    void restore(const LexState &state) {
+        cur_ = state.cur;
+        line_start_ = state.line_start;
+        line_ = state.line;
+        tok_ = state.tok;
+    }
+
+    bool error(const std::string &msg) { return error_at(tok_, msg); }
+    bool error_at(const Token &tok, const std::string &msg);
+    bool expect(char c);
+
+    bool parse_top_level();
+    bool parse_global();
+    bool parse_function();
+    bool parse_body(Function *func);
+    bool parse_instr(BasicBlock *bb);
+    bool parse_two_operands();
+    bool parse_phi_operands(Type *ty);
+
+    bool is_type_start() const;
+    Type *parse_type();
+    Value *parse_value(Type *ty);
+    Value *parse_typed_value();
+    Constant *parse_constant(Type *ty);
+    Constant *parse_constant_array(ArrayType *ty);
+    Value *get_local(llvm::StringRef name, Type *ty);
+
+    const char *cur_;
+    const char *end_;
+    const char *line_start_;
+    unsigned line_{1};
+    Token tok_;
+    // the last comment skipped by lex()
+    llvm::StringRef comment_;
+    unsigned comment_line_{0};
+    std::string err_;
+
+    Module *m_{nullptr};
+    llvm::StringMap<Value *> globals_;
+    // bodies are parsed once every function has been declared
+    std::vector<std::pair<Function *, LexState>> bodies_;
+
+    // the function being parsed
+    llvm::StringMap<Value *> locals_;
+    // stand-ins for instructions used before they are defined
+    llvm::StringMap<std::unique_ptr<Argument>> forward_refs_;
+    std::vector<Value *> operands_;
+};
+
+void IRParser::lex() {
+    while (cur_ != end_) {
+        if (*cur_ == '\n') {
+            line_++;
+            line_start_ = ++cur_;
+        } else if (std::isspace(static_cast<unsigned char>(*cur_))) {
+            cur_++;
+        } else if (*cur_ == ';') {
+            auto eol = std::find(cur_, end_, '\n');
+            comment_ = llvm::StringRef(cur_, eol - cur_);
+            comment_line_ = line_;
+            cur_ = eol;
+        } else {
+            break;
+        }
+    }
+
+    tok_.line = line_;
+    tok_.col = cur_ - line_start_ + 1;
+    if (cur_ == end_) {
+        tok_.kind = Token::Eof;
+        tok_.text = {};
+        return;
+    }
+    auto start = cur_;
+    auto skip_while = [&](bool (*pred)(char)) {
+        while (cur_ != end_ and pred(*cur_))
+            cur_++;
+    };
+    if (*cur_ == '%' or *cur_ == '@') {
+        tok_.kind = *cur_ == '%' ? Token::LocalName : Token::GlobalName;
+        cur_++;
+        skip_while(is_name_char);
+        start++;
+    } else if (*cur_ == '0' and end_ - cur_ > 1 and cur_[1] == 'x') {
+        tok_.kind = Token::Hex;
+        cur_ += 2;
+        skip_while(is_hex_digit);
+        start += 2;
+    } else if (is_digit(*cur_) or
+               (*cur_ == '-' and end_ - cur_ > 1 and is_digit(cur_[1]))) {
+        tok_.kind = Token::Int;
+        cur_++;
+        skip_while(is_digit);
+    } else if (is_name_char(*cur_)) {
+        tok_.kind = Token::Word;
+        skip_while(is_name_char);
+    } else if (*cur_ == '"') {
+        tok_.kind = Token::String;
+        cur_ = std::find_if(cur_ + 1, end_,
+                            [](char c) { return c == '"' or c == '\n'; });
+        if (cur_ == end_ or *cur_ != '"') {
+            error("unterminated string");
+            tok_.kind = Token::Eof;
+        } else {
+            tok_.text = llvm::StringRef(start + 1, cur_ - start - 1);
+            cur_++;
+        }
+        return;
+    } else {
+        tok_.kind = Token::Punct;
+        cur_++;
+    }
+    tok_.text = llvm::StringRef(start, cur_ - start);
+}
+
+Token IRParser::peek() {
+    auto state = save();
+    lex();
+    auto next = tok_;
+    restore(state);
+    return next;
+}
+
+bool IRParser::error_at(const Token &tok, const std::string &msg) {
+    if (err_.empty())
+        err_ = std::to_string(tok.line) + ":" + std::to_string(tok.col) +
+               ": " + msg;
+    return false;
+}
+
+bool IRParser::expect(char c) {
+    if (not tok_.is(c))
+        return error(std::string("expected '") + c + "'");
+    lex();
+    return true;
+}
+
+bool IRParser::is_type_start() const {
+    return tok_.is('[') or tok_.is_word("void") or tok_.is_word("label") or
+           tok_.is_word("float") or tok_.is_word("i1") or
+           tok_.is_word("i32");
+}
+
+Type *IRParser::parse_type() {
+    Type *ty = nullptr;
+    if (tok_.is_word("void")) {
+        ty = m_->get_void_type();
+    } else if (tok_.is_word("label")) {
+        ty = m_->get_label_type();
+    } else if (tok_.is_word("float")) {
+        ty = m_->get_float_type();
+    } else if (tok_.is_word("i1")) {
+        ty = m_->get_int1_type();
+    } else if (tok_.is_word("i32")) {
+        ty = m_->get_int32_type();
+    } else if (tok_.is('[')) {
+        // "[N x elem]"
+        lex();
+        unsigned num;
+        if (tok_.kind != Token::Int or tok_.text.getAsInteger(10, num)) {
+            error("expected the number of array elements");
+            return nullptr;
+        }
+        lex();
+        if (not tok_.is_word("x")) {
+            error("expected 'x'");
+            return nullptr;
+        }
+        lex();
+        auto elem_ty = parse_type();
+        if (elem_ty == nullptr)
+            return nullptr;
+        if (not ArrayType::is_valid_element_type(elem_ty)) {
+            error("invalid array element type");
+            return nullptr;
+        }
+        if (not tok_.is(']')) {
+            error("expected ']'");
+            return nullptr;
+        }
+        ty = m_->get_array_type(elem_ty, num);
+    } else {
+        error("expected a type");
+        return nullptr;
+    }
+    lex();
+
+    while (tok_.is('*')) {
+        if (not PointerType::is_valid_element_type(ty)) {
+            error("invalid pointer element type");
+            return nullptr;
+        }
+        ty = m_->get_pointer_type(ty);
+        lex();
+    }
+    return ty;
+}
+
+Value *IRParser::get_local(llvm::StringRef name, Type *ty) {
+    auto it = locals_.find(name);
+    if (it != locals_.end())
+        return it->second;
+    // every block is known before the first instruction is parsed
+    if (ty->is_label_type()) {
+        error("use of undefined label '%" + name.str() + "'");
+        return nullptr;
+    }
+    auto &forward_ref = forward_refs_[name];
+    if (not forward_ref)
+        forward_ref = std::make_unique<Argument>(ty);
+    return forward_ref.get();
+}
+
+Value *IRParser::parse_value(Type *ty) {
+    Value *v = nullptr;
+    if (tok_.kind == Token::LocalName) {
+        v = get_local(tok_.text, ty);
+    } else if (tok_.kind == Token::GlobalName) {
+        auto it = globals_.find(tok_.text);
+        if (it != globals_.end())
+            v = it->second;
+        else
+            error("use of undefined value '@" + tok_.text.str() + "'");
+    } else {
+        return parse_constant(ty);
+    }
+    if (v == nullptr)
+        return nullptr;
+    if (v->get_type() != ty) {
+        error("'" + tok_.text.str() + "' is not of type " + type_str(ty));
+        return nullptr;
+    }
+    lex();
+    return v;
+}
+
+Value *IRParser::parse_typed_value() {
+    auto ty = parse_type();
+    return ty ? parse_value(ty) : nullptr;
+}
+
+Constant *IRParser::parse_constant(Type *ty) {
+    Constant *c = nullptr;
+    if (tok_.kind == Token::Int and ty->is_int32_type()) {
+        int64_t val;
+        if (tok_.text.getAsInteger(10, val) or
+            val != static_cast<int32_t>(val)) {
+            error("integer constant out of range");
+            return nullptr;
+        }
+        c = ConstantInt::get(static_cast<int>(val), m_);
+    } else if ((tok_.is_word("true") or tok_.is_word("false")) and
+               ty->is_int1_type()) {
+        c = ConstantInt::get(tok_.text == "true", m_);
+    } else if (tok_.kind == Token::Hex and ty->is_float_type()) {
+        // the bits of the equivalent double, see ConstantFP::print()
+        uint64_t bits;
+        if (tok_.text.getAsInteger(16, bits)) {
+            error("invalid float constant");
+            return nullptr;
+        }
+        double val;
+        std::memcpy(&val, &bits, sizeof(val));
+        c = ConstantFP::get(static_cast<float>(val), m_);
+    } else if (tok_.is_word("zeroinitializer")) {
+        c = ConstantZero::get(ty, m_);
+    } else if (tok_.is('[') and ty->is_array_type()) {
+        return parse_constant_array(static_cast<ArrayType *>(ty));
+    } else {
+        error("expected a constant of type " + type_str(ty));
+        return nullptr;
+    }
+    lex();
+    return c;
+}
+
+// "[ty elem, ty elem]"
+Constant *IRParser::parse_constant_array(ArrayType *ty) {
+    lex();
+    std::vector<Constant *> elems;
+    while (not tok_.is(']')) {
+        if (not elems.empty() and not expect(','))
+            return nullptr;
+        auto elem_ty = parse_type();
+        if (elem_ty == nullptr)
+            return nullptr;
+        if (elem_ty != ty->get_element_type()) {
+            error("array element is not of type " +
+                  type_str(ty->get_element_type()));
+            return nullptr;
+        }
+        auto elem = parse_constant(elem_ty);
+        if (elem == nullptr)
+            return nullptr;
+        elems.push_back(elem);
+    }
+    if (elems.size() != ty->get_num_of_elements()) {
+        error("expected " + std::to_string(ty->get_num_of_elements()) +
+              " array elements");
+        return nullptr;
+    }
+    lex();
+    return ConstantArray::get(ty, elems);
+}
+
+bool IRParser::parse_top_level() {
+    if (tok_.kind == Token::GlobalName)
+        return parse_global();
+    if (tok_.is_word("declare") or tok_.is_word("define"))
+        return parse_function();
+    if (tok_.is_word("source_filename")) {
+        lex();
+        if (not expect('='))
+            return false;
+        if (tok_.kind != Token::String)
+            return error("expected a string");
+        lex();
+        return true;
+    }
+    return error("expected a global variable or a function");
+}
+
+// "@name = global|constant ty init"
+bool IRParser::parse_global() {
+    auto name = tok_.text;
+    if (globals_.count(name))
+        return error("redefinition of '@" + name.str() + "'");
+    lex();
+    if (not expect('='))
+        return false;
+    if (not tok_.is_word("global") and not tok_.is_word("constant"))
+        return error("expected 'global' or 'constant'");
+    bool is_const = tok_.text == "constant";
+    lex();
+    auto ty_tok = tok_;
+    auto ty = parse_type();
+    if (ty == nullptr)
+        return false;
+    if (not PointerType::is_valid_element_type(ty))
+        return error_at(ty_tok, "invalid global variable type");
+    auto init = parse_constant(ty);
+    if (init == nullptr)
+        return false;
+    globals_[name] = GlobalVariable::create(name.str(), m_, ty, is_const, init);
+    return true;
+}
+
+// "declare ty @name(ty, ...)" or "define ty @name(ty %arg, ...) { ... }"
+bool IRParser::parse_function() {
+    bool is_definition = tok_.is_word("define");
+    lex();
+    auto ret_ty = parse_type();
+    if (ret_ty == nullptr)
+        return false;
+    if (not FunctionType::is_valid_return_type(ret_ty))
+        return error("invalid return type");
+    if (tok_.kind != Token::GlobalName)
+        return error("expected a function name");
+    auto name = tok_.text;
+    if (globals_.count(name))
+        return error("redefinition of '@" + name.str() + "'");
+    lex();
+
+    if (not expect('('))
+        return false;
+    std::vector<Type *> params;
+    std::vector<llvm::StringRef> arg_names;
+    while (not tok_.is(')')) {
+        if (not params.empty() and not expect(','))
+            return false;
+        auto ty = parse_type();
+        if (ty == nullptr)
+            return false;
+        if (not FunctionType::is_valid_argument_type(ty))
+            return error("invalid parameter type");
+        params.push_back(ty);
+        arg_names.emplace_back();
+        if (tok_.kind == Token::LocalName) {
+            arg_names.back() = tok_.text;
+            lex();
+        }
+    }
+    lex();
+
+    auto func = Function::create(m_->get_function_type(ret_ty, params),
+                                 name.str(), m_);
+    globals_[name] = func;
+    auto arg_name = arg_names.begin();
+    for (auto &arg : func->get_args()) {
+        if (not arg_name->empty()) {
+            arg.set_name(arg_name->str());
+            func->reserve_name(arg.get_name());
+        }
+        ++arg_name;
+    }
+    if (not is_definition)
+        return true;
+
+    if (not expect('{'))
+        return false;
+    bodies_.emplace_back(func, save());
+    while (not tok_.is('}') and tok_.kind != Token::Eof)
+        lex();
+    return expect('}');
+}
+
+bool IRParser::parse_body(Function *func) {
+    locals_.clear();
+    for (auto &arg : func->get_args()) {
+        if (not arg.get_name().empty() and
+            not locals_.try_emplace(arg.get_name(), &arg).second)
+            return error("redefinition of '%" + arg.get_name() + "'");
+    }
+
+    // create the blocks in layout order before any branch refers to them
+    auto body = save();
+    while (not tok_.is('}') and tok_.kind != Token::Eof) {
+        if (tok_.kind == Token::Word and peek().is(':')) {
+            if (locals_.count(tok_.text))
+                return error("redefinition of '%" + tok_.text.str() + "'");
+            // create() would add a "label_" prefix to the name
+            auto bb = BasicBlock::create(m_, "", func);
+            bb->set_name(tok_.text.str());
+            func->reserve_name(bb->get_name());
+            locals_[tok_.text] = bb;
+        }
+        lex();
+    }
+    restore(body);
+
+    BasicBlock *bb = nullptr;
+    std::vector<std::pair<BasicBlock *, llvm::StringRef>> preds;
+    while (not tok_.is('}')) {
+        if (tok_.kind == Token::Eof)
+            return error("expected '}'");
+        if (tok_.kind == Token::Word and peek().is(':')) {
+            if (bb and not bb->is_terminated())
+                return error("block '%" + bb->get_name() +
+                             "' does not end with a terminator");
+            bb = cast<BasicBlock>(locals_[tok_.text]);
+            auto line = tok_.line;
+            lex();
+            lex();
+            // the printer lists the predecessors after the label
+            auto comment = comment_;
+            if (comment_line_ == line and comment.consume_front("; preds = "))
+                preds.emplace_back(bb, comment);
+            continue;
+        }
+        if (bb == nullptr)
+            return error("expected a block label");
+        if (not parse_instr(bb))
+            return false;
+    }
+    if (bb and not bb->is_terminated())
+        return error("block '%" + bb->get_name() +
+                     "' does not end with a terminator");
+    if (not forward_refs_.empty())
+        return error("use of undefined value '%" +
+                     forward_refs_.begin()->getKey().str() + "'");
+    lex();
+
+    // keep the order in which the predecessors were printed, so that the
+    // module prints the same; a comment that no longer matches is ignored
+    for (auto &[bb, list] : preds) {
+        llvm::SmallVector<llvm::StringRef, 4> names;
+        list.split(names, ',');
+        BasicBlock::BBList order;
+        for (auto name : names) {
+            name = name.trim();
+            auto it = name.consume_front("%") ? locals_.find(name)
+                                              : locals_.end();
+            if (it == locals_.end() or not isa<BasicBlock>(it->second))
+                break;
+            order.push_back(cast<BasicBlock>(it->second));
+        }
+        auto &cur_order = bb->get_pre_basic_blocks();
+        if (std::is_permutation(order.begin(), order.end(), cur_order.begin(),
+                                cur_order.end()))
+            bb->reorder_pre_basic_blocks(order);
+    }
+    return true;
+}
+
+// "ty op0, [ty] op1", the type of op1 is only printed if it differs
+bool IRParser::parse_two_operands() {
+    auto lhs = parse_typed_value();
+    if (lhs == nullptr or not expect(','))
+        return false;
+    auto rhs_ty = is_type_start() ? parse_type() : lhs->get_type();
+    auto rhs = rhs_ty ? parse_value(rhs_ty) : nullptr;
+    if (rhs == nullptr)
+        return false;
+    operands_ = {lhs, rhs};
+    return true;
+}
+
+// "[ val, %bb ], ...", predecessors without a value are printed as undef
+bool IRParser::parse_phi_operands(Type *ty) {
+    auto label_ty = m_->get_label_type();
+    while (true) {
+        if (not expect('['))
+            return false;
+        if (tok_.is_word("undef")) {
+            lex();
+            if (not expect(',') or not parse_value(label_ty))
+                return false;
+        } else {
+            auto val = parse_value(ty);
+            if (val == nullptr or not expect(','))
+                return false;
+            auto val_bb = parse_value(label_ty);
+            if (val_bb == nullptr)
+                return false;
+            operands_.push_back(val);
+            operands_.push_back(val_bb);
+        }
+        if (not expect(']'))
+            return false;
+        if (not tok_.is(','))
+            return true;
+        lex();
+    }
+}
+
+bool IRParser::parse_instr(BasicBlock *bb) {
+    if (bb->is_terminated())
+        return error("instruction after a terminator");
+    llvm::StringRef name;
+    auto name_tok = tok_;
+    if (tok_.kind == Token::LocalName) {
+        name = tok_.text;
+        lex();
+        if (not expect('='))
+            return false;
+    }
+    if (tok_.kind != Token::Word)
+        return error("expected an instruction");
+    auto op_tok = tok_;
+    auto opcode = tok_.text;
+    lex();
+
+    auto id = Instruction::ret;
+    if (opcode == "icmp" or opcode == "fcmp") {
+        if (tok_.kind != Token::Word or
+            not(opcode == "icmp"
+                    ? find_op(tok_.text, Instruction::ge, Instruction::ne, id)
+                    : find_op(tok_.text, Instruction::fge, Instruction::fne,
+                              id)))
+            return error("expected a comparison predicate");
+        lex();
+    } else if (not find_op(opcode, Instruction::ret, Instruction::sitofp,
+                           id) or
+               (Instruction::ge <= id and id <= Instruction::fne)) {
+        return error_at(op_tok, "unknown instruction '" + opcode.str() + "'");
+    }
+
+    // result type, only needed where the operands do not determine it
+    Type *ty = nullptr;
+    operands_.clear();
+    switch (id) {
+    case Instruction::ret:
+        if (tok_.is_word("void")) {
+            lex();
+            break;
+        }
+        operands_.push_back(parse_typed_value());
+        break;
+    case Instruction::br:
+        // "label %bb" or "i1 %cond, label %bb, label %bb"
+        operands_.push_back(parse_typed_value());
+        while (operands_.back() and tok_.is(',')) {
+            lex();
+            operands_.push_back(parse_typed_value());
+        }
+        break;
+    case Instruction::alloca: {
+        auto ty_tok = tok_;
+        auto alloca_ty = parse_type();
+        if (alloca_ty == nullptr)
+            return false;
+        if (not PointerType::is_valid_element_type(alloca_ty))
+            return error_at(ty_tok, "invalid pointer element type");
+        ty = m_->get_pointer_type(alloca_ty);
+        break;
+    }
+    case Instruction::load:
+    case Instruction::getelementptr: {
+        // the element type comes before the pointer
+        auto ty_tok = tok_;
+        auto elem_ty = parse_type();
+        if (elem_ty == nullptr)
+            return false;
+        if (not PointerType::is_valid_element_type(elem_ty))
+            return error_at(ty_tok, "invalid pointer element type");
+        if (not expect(','))
+            return false;
+        auto ptr = parse_typed_value();
+        if (ptr == nullptr)
+            return false;
+        if (ptr->get_type() != m_->get_pointer_type(elem_ty))
+            return error_at(op_tok, "pointer is not of type " +
+                                        type_str(elem_ty) + "*");
+        operands_.push_back(ptr);
+        while (id == Instruction::getelementptr and tok_.is(',')) {
+            lex();
+            operands_.push_back(parse_typed_value());
+            if (operands_.back() == nullptr)
+                return false;
+        }
+        break;
+    }
+    case Instruction::store:
+        operands_.push_back(parse_typed_value());
+        if (operands_.back() == nullptr or not expect(','))
+            return false;
+        operands_.push_back(parse_typed_value());
+        break;
+    case Instruction::phi:
+        ty = parse_type();
+        if (ty == nullptr or not parse_phi_operands(ty))
+            return false;
+        break;
+    case Instruction::call: {
+        // "ty @func(ty arg, ...)"
+        auto ret_ty = parse_type();
+        if (ret_ty == nullptr)
+            return false;
+        if (tok_.kind != Token::GlobalName)
+            return error("expected a function name");
+        auto it = globals_.find(tok_.text);
+        if (it == globals_.end() or not isa<Function>(it->second))
+            return error("'@" + tok_.text.str() + "' is not a function");
+        auto func = cast<Function>(it->second);
+        if (func->get_return_type() != ret_ty)
+            return error("'@" + tok_.text.str() + "' does not return " +
+                         type_str(ret_ty));
+        operands_.push_back(func);
+        lex();
+        if (not expect('('))
+            return false;
+        while (not tok_.is(')')) {
+            if (operands_.size() > 1 and not expect(','))
+                return false;
+            operands_.push_back(parse_typed_value());
+            if (operands_.back() == nullptr)
+                return false;
+        }
+        lex();
+        break;
+    }
+    case Instruction::zext:
+    case Instruction::fptosi:
+    case Instruction::sitofp:
+        // "ty val to ty"
+        operands_.push_back(parse_typed_value());
+        if (operands_.back() == nullptr)
+            return false;
+        if (not tok_.is_word("to"))
+            return error("expected 'to'");
+        lex();
+        ty = parse_type();
+        break;
+    default:
+        // binary operators and comparisons
+        if (not parse_two_operands())
+            return false;
+        break;
+    }
+    if (not err_.empty())
+        return false;
+
+    auto instr = Instruction::create(id, ty, operands_, bb);
+    if (instr == nullptr)
+        return error_at(op_tok, "invalid operands for '" + opcode.str() + "'");
+    if (instr->is_void())
+        return name.empty() or
+               error_at(name_tok, "'" + opcode.str() + "' has no result");
+    if (name.empty())
+        return error_at(op_tok, "the result of '" + opcode.str() +
+                                    "' must be named");
+
+    if (locals_.count(name))
+        return error_at(name_tok, "redefinition of '%" + name.str() + "'");
+    auto it = forward_refs_.find(name);
+    if (it != forward_refs_.end()) {
+        if (it->second->get_type() != instr->get_type())
+            return error_at(name_tok, "'%" + name.str() +
+                                          "' is used with another type");
+        // only a phi may use its own result, through a back edge
+        if (not instr->is_phi() and
+            std::find(operands_.begin(), operands_.end(), it->second.get()) !=
+                operands_.end())
+            return error_at(name_tok, "'%" + name.str() +
+                                          "' is used by its own definition");
+        it->second->replace_all_use_with(instr);
+        forward_refs_.erase(it);
+    }
+    instr->set_name(name.str());
+    bb->get_parent()->reserve_name(instr->get_name());
+    locals_[name] = instr;
+    return true;
+}
+
+std::unique_ptr<Module> IRParser::parse(std::string &err) {
+    auto module = std::make_unique<Module>();
+    m_ = module.get();
+
+    lex();
+    // declare every function first, so that calls may come before callees
+    while (tok_.kind != Token::Eof and err_.empty())
+        parse_top_level();
+    for (auto &[func, body] : bodies_) {
+        if (not err_.empty())
+            break;
+        restore(body);
+        parse_body(func);
+    }
+
+    // drop stand-ins left by a failed parse before the module goes away
+    forward_refs_.clear();
+    if (not err_.empty()) {
+        err = err_;
+        return nullptr;
+    }
+    return module;
+}
+
+} // namespace
+
+std::unique_ptr<Module> parse_ir(const std::string &path, std::string &err) {
+    // "-" reads the standard input
+    auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(path, /*IsText=*/true);
+    if (auto ec = buffer.getError()) {
+        err = path + ": " + ec.message();
+        return nullptr;
+    }
+    auto module = IRParser((*buffer)->getBuffer()).parse(err);
+    if (not module)
+        err = path + ":" + err;
+    return module;
+}
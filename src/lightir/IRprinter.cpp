@@ -1,29 +1,28 @@
 #include "IRprinter.hpp"
 #include "Instruction.hpp"
+
+#include <algorithm>
 #include <cassert>
-#include <type_traits>
+#include <llvm/Support/raw_ostream.h>
 
-std::string print_as_op(Value *v, bool print_ty) {
-    std::string op_ir;
+void print_as_op(llvm::raw_ostream &os, Value *v, bool print_ty) {
     if (print_ty) {
-        op_ir += v->get_type()->print();
-        op_ir += " ";
+        v->get_type()->print(os);
+        os << ' ';
     }
 
-    if (dynamic_cast<GlobalVariable *>(v)) {
-        op_ir += "@" + v->get_name();
-    } else if (dynamic_cast<Function *>(v)) {
-        op_ir += "@" + v->get_name();
-    } else if (dynamic_cast<Constant *>(v)) {
-        op_ir += v->print();
+    if (isa<GlobalVariable>(v)) {
+        os << '@' << v->get_name();
+    } else if (isa<Function>(v)) {
+        os << '@' << v->get_name();
+    } else if (isa<Constant>(v)) {
+        v->print(os);
     } else {
-        op_ir += "%" + v->get_name();
+        os << '%' << v->get_name();
     }
-
-    return op_ir;
 }
 
-std::string print_instr_op_name(Instruction::OpID id) {
+const char *print_instr_op_name(Instruction::OpID id) {
     switch (id) {
     case Instruction::ret:
         return "ret";
@@ -91,233 +90,156 @@ std::string print_instr_op_name(Instruction::OpID id) {
     assert(false && "Must be bug");
 }
 
-template <class BinInst> std::string print_binary_inst(const BinInst &inst) {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += inst.get_name();
-    instr_ir += " = ";
-    instr_ir += inst.get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += inst.get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(inst.get_operand(0), false);
-    instr_ir += ", ";
-    if (inst.get_operand(0)->get_type() == inst.get_operand(1)->get_type()) {
-        instr_ir += print_as_op(inst.get_operand(1), false);
-    } else {
-        instr_ir += print_as_op(inst.get_operand(1), true);
-    }
-    return instr_ir;
+// "%name = "
+static void print_def(llvm::raw_ostream &os, const Instruction &inst) {
+    os << '%' << inst.get_name() << " = ";
 }
-std::string IBinaryInst::print() { return print_binary_inst(*this); }
-std::string FBinaryInst::print() { return print_binary_inst(*this); }
 
-template <class CMP> std::string print_cmp_inst(const CMP &inst) {
-    std::string cmp_type;
-    if (inst.is_cmp())
-        cmp_type = "icmp";
-    else if (inst.is_fcmp())
-        cmp_type = "fcmp";
-    else
-        assert(false && "Unexpected case");
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += inst.get_name();
-    instr_ir += " = " + cmp_type + " ";
-    instr_ir += inst.get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += inst.get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(inst.get_operand(0), false);
-    instr_ir += ", ";
+// "ty op0, op1", the type of op1 only printed if it differs from op0
+static void print_two_operands(llvm::raw_ostream &os, const Instruction &inst) {
+    inst.get_operand(0)->get_type()->print(os);
+    os << ' ';
+    print_as_op(os, inst.get_operand(0), false);
+    os << ", ";
     if (inst.get_operand(0)->get_type() == inst.get_operand(1)->get_type()) {
-        instr_ir += print_as_op(inst.get_operand(1), false);
+        print_as_op(os, inst.get_operand(1), false);
     } else {
-        instr_ir += print_as_op(inst.get_operand(1), true);
+        print_as_op(os, inst.get_operand(1), true);
     }
-    return instr_ir;
 }
-std::string ICmpInst::print() { return print_cmp_inst(*this); }
-std::string FCmpInst::print() { return print_cmp_inst(*this); }
 
-std::string CallInst::print() {
-    std::string instr_ir;
-    if (!this->is_void()) {
-        instr_ir += "%";
-        instr_ir += this->get_name();
-        instr_ir += " = ";
-    }
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_function_type()->get_return_type()->print();
+// "%name = op ty val to dest_ty"
+static void print_cast_inst(llvm::raw_ostream &os, const Instruction &inst,
+                            Type *dest_ty) {
+    print_def(os, inst);
+    os << print_instr_op_name(inst.get_instr_type()) << ' ';
+    inst.get_operand(0)->get_type()->print(os);
+    os << ' ';
+    print_as_op(os, inst.get_operand(0), false);
+    os << " to ";
+    dest_ty->print(os);
+}
 
-    instr_ir += " ";
-    assert(dynamic_cast<Function *>(this->get_operand(0)) &&
+void IBinaryInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    print_two_operands(os, *this);
+}
+void FBinaryInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    print_two_operands(os, *this);
+}
+
+void ICmpInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << "icmp " << print_instr_op_name(get_instr_type()) << ' ';
+    print_two_operands(os, *this);
+}
+void FCmpInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << "fcmp " << print_instr_op_name(get_instr_type()) << ' ';
+    print_two_operands(os, *this);
+}
+
+void CallInst::print(llvm::raw_ostream &os) {
+    if (!this->is_void())
+        print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    this->get_function_type()->get_return_type()->print(os);
+    os << ' ';
+    assert(isa<Function>(this->get_operand(0)) &&
            "Wrong call operand function");
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += "(";
+    print_as_op(os, this->get_operand(0), false);
+    os << '(';
     for (unsigned i = 1; i < this->get_num_operand(); i++) {
         if (i > 1)
-            instr_ir += ", ";
-        instr_ir += this->get_operand(i)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(i), false);
+            os << ", ";
+        print_as_op(os, this->get_operand(i), true);
     }
-    instr_ir += ")";
-    return instr_ir;
+    os << ')';
 }
 
-std::string BranchInst::print() {
-    std::string instr_ir;
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), true);
+void BranchInst::print(llvm::raw_ostream &os) {
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    print_as_op(os, this->get_operand(0), true);
     if (is_cond_br()) {
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(1), true);
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(2), true);
+        os << ", ";
+        print_as_op(os, this->get_operand(1), true);
+        os << ", ";
+        print_as_op(os, this->get_operand(2), true);
     }
-    return instr_ir;
 }
 
-std::string ReturnInst::print() {
-    std::string instr_ir;
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
+void ReturnInst::print(llvm::raw_ostream &os) {
+    os << print_instr_op_name(get_instr_type()) << ' ';
     if (!is_void_ret()) {
-        instr_ir += this->get_operand(0)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(0), false);
+        print_as_op(os, this->get_operand(0), true);
     } else {
-        instr_ir += "void";
+        os << "void";
     }
-
-    return instr_ir;
 }
 
-std::string GetElementPtrInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
+void GetElementPtrInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
     assert(this->get_operand(0)->get_type()->is_pointer_type());
-    instr_ir +=
-        this->get_operand(0)->get_type()->get_pointer_element_type()->print();
-    instr_ir += ", ";
+    this->get_operand(0)->get_type()->get_pointer_element_type()->print(os);
+    os << ", ";
     for (unsigned i = 0; i < this->get_num_operand(); i++) {
         if (i > 0)
-            instr_ir += ", ";
-        instr_ir += this->get_operand(i)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(i), false);
+            os << ", ";
+        print_as_op(os, this->get_operand(i), true);
     }
-    return instr_ir;
 }
 
-std::string StoreInst::print() {
-    std::string instr_ir;
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += ", ";
-    instr_ir += print_as_op(this->get_operand(1), true);
-    return instr_ir;
+void StoreInst::print(llvm::raw_ostream &os) {
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    print_as_op(os, this->get_operand(0), true);
+    os << ", ";
+    print_as_op(os, this->get_operand(1), true);
 }
 
-std::string LoadInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
+void LoadInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
     assert(this->get_operand(0)->get_type()->is_pointer_type());
-    instr_ir +=
-        this->get_operand(0)->get_type()->get_pointer_element_type()->print();
-    instr_ir += ",";
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), true);
-    return instr_ir;
+    this->get_operand(0)->get_type()->get_pointer_element_type()->print(os);
+    os << ", ";
+    print_as_op(os, this->get_operand(0), true);
 }
 
-std::string AllocaInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += get_alloca_type()->print();
-    return instr_ir;
+void AllocaInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    get_alloca_type()->print(os);
 }
 
-std::string ZextInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += " to ";
-    instr_ir += this->get_dest_type()->print();
-    return instr_ir;
+void ZextInst::print(llvm::raw_ostream &os) {
+    print_cast_inst(os, *this, get_dest_type());
 }
 
-std::string FpToSiInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += " to ";
-    instr_ir += this->get_dest_type()->print();
-    return instr_ir;
+void FpToSiInst::print(llvm::raw_ostream &os) {
+    print_cast_inst(os, *this, get_dest_type());
 }
 
-std::string SiToFpInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += " to ";
-    instr_ir += this->get_dest_type()->print();
-    return instr_ir;
+void SiToFpInst::print(llvm::raw_ostream &os) {
+    print_cast_inst(os, *this, get_dest_type());
 }
 
-std::string PhiInst::print() {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += get_instr_op_name();
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
+void PhiInst::print(llvm::raw_ostream &os) {
+    print_def(os, *this);
+    os << print_instr_op_name(get_instr_type()) << ' ';
+    this->get_operand(0)->get_type()->print(os);
+    os << ' ';
     for (unsigned i = 0; i < this->get_num_operand() / 2; i++) {
         if (i > 0)
-            instr_ir += ", ";
-        instr_ir += "[ ";
-        instr_ir += print_as_op(this->get_operand(2 * i), false);
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(2 * i + 1), false);
-        instr_ir += " ]";
+            os << ", ";
+        os << "[ ";
+        print_as_op(os, this->get_operand(2 * i), false);
+        os << ", ";
+        print_as_op(os, this->get_operand(2 * i + 1), false);
+        os << " ]";
     }
     if (this->get_num_operand() / 2 <
         this->get_parent()->get_pre_basic_blocks().size()) {
@@ -327,9 +249,10 @@ std::string PhiInst::print() {
                           static_cast<Value *>(pre_bb)) ==
                 this->get_operands().end()) {
                 // find a pre_bb is not in phi
-                instr_ir += ", [ undef, " + print_as_op(pre_bb, false) + " ]";
+                os << ", [ undef, ";
+                print_as_op(os, pre_bb, false);
+                os << " ]";
             }
         }
     }
-    return instr_ir;
 }
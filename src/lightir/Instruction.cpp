@@ -12,16 +12,84 @@
 #include <vector>
 
 Instruction::Instruction(Type *ty, OpID id, BasicBlock *parent)
-    : User(ty, ""), op_id_(id), parent_(parent) {
+    : User(static_cast<ValueID>(InstructionVal + id), ty, ""),
+      parent_(parent) {
     if (parent)
         parent->add_instruction(this);
 }
 
+void *Instruction::allocate(std::size_t size, BasicBlock *bb) {
+    assert(bb && "Instruction should be created in a BasicBlock");
+    return bb->get_module()->get_arena().allocate(size, alignof(Instruction));
+}
+
+// The object size for each OpID, used to find the right free list when an
+// erased instruction is given back to the arena.
+static std::size_t instr_size(Instruction::OpID id) {
+    switch (id) {
+    case Instruction::ret:
+        return sizeof(ReturnInst);
+    case Instruction::br:
+        return sizeof(BranchInst);
+    case Instruction::add:
+    case Instruction::sub:
+    case Instruction::mul:
+    case Instruction::sdiv:
+        return sizeof(IBinaryInst);
+    case Instruction::fadd:
+    case Instruction::fsub:
+    case Instruction::fmul:
+    case Instruction::fdiv:
+        return sizeof(FBinaryInst);
+    case Instruction::alloca:
+        return sizeof(AllocaInst);
+    case Instruction::load:
+        return sizeof(LoadInst);
+    case Instruction::store:
+        return sizeof(StoreInst);
+    case Instruction::ge:
+    case Instruction::gt:
+    case Instruction::le:
+    case Instruction::lt:
+    case Instruction::eq:
+    case Instruction::ne:
+        return sizeof(ICmpInst);
+    case Instruction::fge:
+    case Instruction::fgt:
+    case Instruction::fle:
+    case Instruction::flt:
+    case Instruction::feq:
+    case Instruction::fne:
+        return sizeof(FCmpInst);
+    case Instruction::phi:
+        return sizeof(PhiInst);
+    case Instruction::call:
+        return sizeof(CallInst);
+    case Instruction::getelementptr:
+        return sizeof(GetElementPtrInst);
+    case Instruction::zext:
+        return sizeof(ZextInst);
+    case Instruction::fptosi:
+        return sizeof(FpToSiInst);
+    case Instruction::sitofp:
+        return sizeof(SiToFpInst);
+    }
+    assert(false && "Must be bug");
+    return 0;
+}
+
+void llvm::ilist_alloc_traits<Instruction>::deleteNode(Instruction *instr) {
+    auto &arena = instr->get_module()->get_arena();
+    auto size = instr_size(instr->get_instr_type());
+    instr->~Instruction();
+    arena.deallocate(instr, size);
+}
+
 Function *Instruction::get_function() { return parent_->get_parent(); }
 Module *Instruction::get_module() { return parent_->get_module(); }
 
 std::string Instruction::get_instr_op_name() const {
-    return print_instr_op_name(op_id_);
+    return print_instr_op_name(get_instr_type());
 }
 
 IBinaryInst::IBinaryInst(OpID id, Value *v1, Value *v2, BasicBlock *bb)
@@ -126,6 +194,7 @@ CallInst::CallInst(Function *func, std::vector<Value *> args, BasicBlock *bb)
     : BaseInst<CallInst>(func->get_return_type(), call, bb) {
     assert(func->get_type()->is_function_type() && "Not a function");
     assert((func->get_num_of_args() == args.size()) && "Wrong number of args");
+    reserve_operands(args.size() + 1);
     add_operand(func);
     auto func_type = static_cast<FunctionType *>(func->get_type());
     for (unsigned i = 0; i < args.size(); i++) {
@@ -150,37 +219,29 @@ BranchInst::BranchInst(Value *cond, BasicBlock *if_true, BasicBlock *if_false,
     if (cond == nullptr) { // conditionless jump
         assert(if_false == nullptr && "Given false-bb on conditionless jump");
         add_operand(if_true);
-        // prev/succ
-        if_true->add_pre_basic_block(bb);
-        bb->add_succ_basic_block(if_true);
+        BasicBlock::add_edge(bb, if_true);
     } else {
         assert(cond->get_type()->is_int1_type() &&
                "BranchInst condition is not i1");
         add_operand(cond);
         add_operand(if_true);
         add_operand(if_false);
-        // prev/succ
-        if_true->add_pre_basic_block(bb);
-        if_false->add_pre_basic_block(bb);
-        bb->add_succ_basic_block(if_true);
-        bb->add_succ_basic_block(if_false);
+        BasicBlock::add_edge(bb, if_true);
+        BasicBlock::add_edge(bb, if_false);
     }
 }
 
 BranchInst::~BranchInst() {
-    std::list<BasicBlock *> succs;
-    if (is_cond_br()) {
-        succs.push_back(static_cast<BasicBlock *>(get_operand(1)));
-        succs.push_back(static_cast<BasicBlock *>(get_operand(2)));
-    } else {
-        succs.push_back(static_cast<BasicBlock *>(get_operand(0)));
-    }
-    for (auto succ_bb : succs) {
-        if (succ_bb) {
-            succ_bb->remove_pre_basic_block(get_parent());
-            get_parent()->remove_succ_basic_block(succ_bb);
-        }
-    }
+    // drop the edges while this is still a BranchInst, ~User() finds no
+    // operands left
+    remove_all_operands();
+}
+
+void BranchInst::replace_target(Value *old_val, Value *new_val) {
+    if (auto old_bb = dyn_cast_or_null<BasicBlock>(old_val))
+        BasicBlock::remove_edge(get_parent(), old_bb);
+    if (auto new_bb = dyn_cast_or_null<BasicBlock>(new_val))
+        BasicBlock::add_edge(get_parent(), new_bb);
 }
 
 BranchInst *BranchInst::create_cond_br(Value *cond, BasicBlock *if_true,
@@ -218,6 +279,7 @@ GetElementPtrInst::GetElementPtrInst(Value *ptr, std::vector<Value *> idxs,
                                      BasicBlock *bb)
     : BaseInst<GetElementPtrInst>(PointerType::get(get_element_type(ptr, idxs)),
                                   getelementptr, bb) {
+    reserve_operands(idxs.size() + 1);
     add_operand(ptr);
     for (unsigned i = 0; i < idxs.size(); i++) {
         Value *idx = idxs[i];
@@ -349,6 +411,7 @@ PhiInst::PhiInst(Type *ty, std::vector<Value *> vals,
                  std::vector<BasicBlock *> val_bbs, BasicBlock *bb)
     : BaseInst<PhiInst>(ty, phi) {
     assert(vals.size() == val_bbs.size() && "Unmatched vals and bbs");
+    reserve_operands(vals.size() * 2);
     for (unsigned i = 0; i < vals.size(); i++) {
         assert(ty == vals[i]->get_type() && "Bad type for phi");
         add_operand(vals[i]);
@@ -362,3 +425,199 @@ PhiInst *PhiInst::create_phi(Type *ty, BasicBlock *bb,
                              std::vector<BasicBlock *> val_bbs) {
     return create(ty, vals, val_bbs, bb);
 }
+
+// Whether a gep with num_idxs indices can be applied to ptr, see
+// GetElementPtrInst::get_element_type()
+static bool is_valid_gep(Value *ptr, unsigned num_idxs) {
+    if (not ptr->get_type()->is_pointer_type())
+        return false;
+    Type *ty = ptr->get_type()->get_pointer_element_type();
+    if (not ty->is_array_type())
+        return ty->is_integer_type() or ty->is_float_type();
+    for (unsigned i = 1; i + 1 < num_idxs; i++) {
+        ty = static_cast<ArrayType *>(ty)->get_element_type();
+        if (not ty->is_array_type())
+            return false;
+    }
+    return true;
+}
+
+Instruction *Instruction::create(OpID id, Type *ty,
+                                 const std::vector<Value *> &ops,
+                                 BasicBlock *bb) {
+    auto num_ops = ops.size();
+    for (auto v : ops)
+        if (v == nullptr)
+            return nullptr;
+    auto is_block = [&](unsigned i) { return isa<BasicBlock>(ops[i]); };
+    auto has_type = [&](unsigned i, bool (Type::*pred)() const) {
+        return (ops[i]->get_type()->*pred)();
+    };
+
+    switch (id) {
+    case ret: {
+        auto ret_ty = bb->get_parent()->get_return_type();
+        if (num_ops == 0 and ret_ty->is_void_type())
+            return ReturnInst::create_void_ret(bb);
+        if (num_ops == 1 and ops[0]->get_type() == ret_ty and
+            not ret_ty->is_void_type())
+            return ReturnInst::create_ret(ops[0], bb);
+        return nullptr;
+    }
+    case br:
+        if (num_ops == 1 and is_block(0))
+            return BranchInst::create_br(cast<BasicBlock>(ops[0]), bb);
+        if (num_ops == 3 and has_type(0, &Type::is_int1_type) and
+            is_block(1) and is_block(2))
+            return BranchInst::create_cond_br(
+                ops[0], cast<BasicBlock>(ops[1]), cast<BasicBlock>(ops[2]), bb);
+        return nullptr;
+    case add:
+    case sub:
+    case mul:
+    case sdiv:
+    case ge:
+    case gt:
+    case le:
+    case lt:
+    case eq:
+    case ne:
+        if (num_ops != 2 or not has_type(0, &Type::is_int32_type) or
+            not has_type(1, &Type::is_int32_type))
+            return nullptr;
+        switch (id) {
+        case add:
+            return IBinaryInst::create_add(ops[0], ops[1], bb);
+        case sub:
+            return IBinaryInst::create_sub(ops[0], ops[1], bb);
+        case mul:
+            return IBinaryInst::create_mul(ops[0], ops[1], bb);
+        case sdiv:
+            return IBinaryInst::create_sdiv(ops[0], ops[1], bb);
+        case ge:
+            return ICmpInst::create_ge(ops[0], ops[1], bb);
+        case gt:
+            return ICmpInst::create_gt(ops[0], ops[1], bb);
+        case le:
+            return ICmpInst::create_le(ops[0], ops[1], bb);
+        case lt:
+            return ICmpInst::create_lt(ops[0], ops[1], bb);
+        case eq:
+            return ICmpInst::create_eq(ops[0], ops[1], bb);
+        default:
+            return ICmpInst::create_ne(ops[0], ops[1], bb);
+        }
+    case fadd:
+    case fsub:
+    case fmul:
+    case fdiv:
+    case fge:
+    case fgt:
+    case fle:
+    case flt:
+    case feq:
+    case fne:
+        if (num_ops != 2 or not has_type(0, &Type::is_float_type) or
+            not has_type(1, &Type::is_float_type))
+            return nullptr;
+        switch (id) {
+        case fadd:
+            return FBinaryInst::create_fadd(ops[0], ops[1], bb);
+        case fsub:
+            return FBinaryInst::create_fsub(ops[0], ops[1], bb);
+        case fmul:
+            return FBinaryInst::create_fmul(ops[0], ops[1], bb);
+        case fdiv:
+            return FBinaryInst::create_fdiv(ops[0], ops[1], bb);
+        case fge:
+            return FCmpInst::create_fge(ops[0], ops[1], bb);
+        case fgt:
+            return FCmpInst::create_fgt(ops[0], ops[1], bb);
+        case fle:
+            return FCmpInst::create_fle(ops[0], ops[1], bb);
+        case flt:
+            return FCmpInst::create_flt(ops[0], ops[1], bb);
+        case feq:
+            return FCmpInst::create_feq(ops[0], ops[1], bb);
+        default:
+            return FCmpInst::create_fne(ops[0], ops[1], bb);
+        }
+    case alloca: {
+        if (num_ops != 0 or not ty->is_pointer_type())
+            return nullptr;
+        auto elem_ty = ty->get_pointer_element_type();
+        if (not(elem_ty->is_integer_type() or elem_ty->is_float_type() or
+                elem_ty->is_array_type() or elem_ty->is_pointer_type()))
+            return nullptr;
+        return AllocaInst::create_alloca(elem_ty, bb);
+    }
+    case load: {
+        if (num_ops != 1 or not has_type(0, &Type::is_pointer_type))
+            return nullptr;
+        auto elem_ty = ops[0]->get_type()->get_pointer_element_type();
+        if (not(elem_ty->is_integer_type() or elem_ty->is_float_type() or
+                elem_ty->is_pointer_type()))
+            return nullptr;
+        return LoadInst::create_load(ops[0], bb);
+    }
+    case store:
+        if (num_ops != 2 or not has_type(1, &Type::is_pointer_type) or
+            ops[1]->get_type()->get_pointer_element_type() !=
+                ops[0]->get_type())
+            return nullptr;
+        return StoreInst::create_store(ops[0], ops[1], bb);
+    case phi: {
+        if (num_ops == 0 or num_ops % 2 != 0)
+            return nullptr;
+        std::vector<Value *> vals;
+        std::vector<BasicBlock *> val_bbs;
+        for (unsigned i = 0; i < num_ops; i += 2) {
+            if (ops[i]->get_type() != ty or not is_block(i + 1))
+                return nullptr;
+            vals.push_back(ops[i]);
+            val_bbs.push_back(cast<BasicBlock>(ops[i + 1]));
+        }
+        auto phi = PhiInst::create_phi(ty, bb, vals, val_bbs);
+        bb->add_instruction(phi);
+        return phi;
+    }
+    case call: {
+        auto func = num_ops ? dyn_cast<Function>(ops[0]) : nullptr;
+        if (func == nullptr or func->get_num_of_args() != num_ops - 1)
+            return nullptr;
+        for (unsigned i = 1; i < num_ops; i++)
+            if (func->get_function_type()->get_param_type(i - 1) !=
+                ops[i]->get_type())
+                return nullptr;
+        std::vector<Value *> args(ops.begin() + 1, ops.end());
+        return CallInst::create_call(func, args, bb);
+    }
+    case getelementptr: {
+        if (num_ops == 0 or not is_valid_gep(ops[0], num_ops - 1))
+            return nullptr;
+        for (unsigned i = 1; i < num_ops; i++)
+            if (not has_type(i, &Type::is_integer_type))
+                return nullptr;
+        std::vector<Value *> idxs(ops.begin() + 1, ops.end());
+        return GetElementPtrInst::create_gep(ops[0], idxs, bb);
+    }
+    case zext:
+        if (num_ops != 1 or not has_type(0, &Type::is_integer_type) or
+            not ty->is_integer_type() or
+            static_cast<IntegerType *>(ops[0]->get_type())->get_num_bits() >=
+                static_cast<IntegerType *>(ty)->get_num_bits())
+            return nullptr;
+        return ZextInst::create_zext(ops[0], ty, bb);
+    case fptosi:
+        if (num_ops != 1 or not has_type(0, &Type::is_float_type) or
+            not ty->is_integer_type())
+            return nullptr;
+        return FpToSiInst::create_fptosi(ops[0], ty, bb);
+    case sitofp:
+        if (num_ops != 1 or not has_type(0, &Type::is_integer_type) or
+            not ty->is_float_type())
+            return nullptr;
+        return SiToFpInst::create_sitofp(ops[0], bb);
+    }
+    return nullptr;
+}
@@ -0,0 +1,243 @@
+#include "Linker.hpp"
+#include "BasicBlock.hpp"
+#include "Casting.hpp"
+#include "Constant.hpp"
+#include "Function.hpp"
+#include "GlobalVariable.hpp"
+#include "Instruction.hpp"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <memory>
+#include <vector>
+
+namespace {
+
+class Linker {
+  public:
+    Linker(Module *dst, Module *src) : dst_(dst), src_(src) {}
+
+    bool link(std::string &err);
+
+  private:
+    bool link_global(GlobalVariable &global);
+    bool link_function(Function &func);
+    void clone_body(Function &from, Function *to);
+
+    Type *map_type(Type *ty);
+    Value *map_value(Value *v);
+
+    bool error(const std::string &msg) {
+        if (err_.empty())
+            err_ = msg;
+        return false;
+    }
+
+    Module *dst_;
+    Module *src_;
+    // functions and globals of dst, by name
+    llvm::StringMap<Value *> symbols_;
+    // values of src to their counterparts in dst
+    llvm::DenseMap<Value *, Value *> values_;
+    // stand-ins for instructions used before they are cloned
+    llvm::DenseMap<Value *, std::unique_ptr<Argument>> forward_refs_;
+    std::vector<std::pair<Function *, Function *>> bodies_;
+    std::string err_;
+};
+
+Type *Linker::map_type(Type *ty) {
+    switch (ty->get_type_id()) {
+    case Type::VoidTyID:
+        return dst_->get_void_type();
+    case Type::LabelTyID:
+        return dst_->get_label_type();
+    case Type::IntegerTyID:
+        if (ty->is_int1_type())
+            return dst_->get_int1_type();
+        return dst_->get_int32_type();
+    case Type::FloatTyID:
+        return dst_->get_float_type();
+    case Type::PointerTyID:
+        return dst_->get_pointer_type(
+            map_type(ty->get_pointer_element_type()));
+    case Type::ArrayTyID: {
+        auto array_ty = static_cast<ArrayType *>(ty);
+        return dst_->get_array_type(map_type(array_ty->get_element_type()),
+                                    array_ty->get_num_of_elements());
+    }
+    case Type::FunctionTyID: {
+        auto func_ty = static_cast<FunctionType *>(ty);
+        std::vector<Type *> params;
+        for (auto param : func_ty->get_params())
+            params.push_back(map_type(param));
+        return dst_->get_function_type(map_type(func_ty->get_return_type()),
+                                       params);
+    }
+    }
+    assert(false && "unknown type");
+    return nullptr;
+}
+
+Value *Linker::map_value(Value *v) {
+    auto it = values_.find(v);
+    if (it != values_.end())
+        return it->second;
+
+    Value *mapped = nullptr;
+    if (auto c = dyn_cast<ConstantInt>(v)) {
+        if (c->get_type()->is_int1_type())
+            mapped = ConstantInt::get(c->get_value() != 0, dst_);
+        else
+            mapped = ConstantInt::get(c->get_value(), dst_);
+    } else if (auto c = dyn_cast<ConstantFP>(v)) {
+        mapped = ConstantFP::get(c->get_value(), dst_);
+    } else if (isa<ConstantZero>(v)) {
+        mapped = ConstantZero::get(map_type(v->get_type()), dst_);
+    } else if (auto c = dyn_cast<ConstantArray>(v)) {
+        std::vector<Constant *> elements;
+        for (unsigned i = 0; i < c->get_size_of_array(); i++)
+            elements.push_back(
+                cast<Constant>(map_value(c->get_element_value(i))));
+        mapped = ConstantArray::get(
+            static_cast<ArrayType *>(map_type(c->get_type())), elements);
+    } else {
+        // every symbol and block is mapped up front, so this is an
+        // instruction whose definition comes later in layout order
+        assert(isa<Instruction>(v) && "unmapped value");
+        auto &forward_ref = forward_refs_[v];
+        if (not forward_ref)
+            forward_ref = std::make_unique<Argument>(map_type(v->get_type()));
+        return forward_ref.get();
+    }
+    values_[v] = mapped;
+    return mapped;
+}
+
+bool Linker::link_global(GlobalVariable &global) {
+    auto &name = global.get_name();
+    auto elem_ty = map_type(global.get_type()->get_pointer_element_type());
+    auto &symbol = symbols_[name];
+    if (symbol == nullptr) {
+        auto init = cast<Constant>(map_value(global.get_init()));
+        symbol = GlobalVariable::create(name, dst_, elem_ty, global.is_const(),
+                                        init);
+        values_[&global] = symbol;
+        return true;
+    }
+
+    auto existing = dyn_cast<GlobalVariable>(symbol);
+    if (existing == nullptr)
+        return error("'" + name + "' is both a function and a variable");
+    if (existing->get_type()->get_pointer_element_type() != elem_ty or
+        existing->is_const() != global.is_const())
+        return error("conflicting types for '" + name + "'");
+    if (not isa<ConstantZero>(existing->get_init()) or
+        not isa<ConstantZero>(global.get_init()))
+        return error("redefinition of '" + name + "'");
+    values_[&global] = existing;
+    return true;
+}
+
+bool Linker::link_function(Function &func) {
+    auto &name = func.get_name();
+    auto func_ty = static_cast<FunctionType *>(map_type(func.get_type()));
+    auto &symbol = symbols_[name];
+    if (symbol == nullptr)
+        symbol = Function::create(func_ty, name, dst_);
+
+    auto existing = dyn_cast<Function>(symbol);
+    if (existing == nullptr)
+        return error("'" + name + "' is both a function and a variable");
+    if (existing->get_function_type() != func_ty)
+        return error("conflicting types for '" + name + "'");
+    if (not func.is_declaration()) {
+        if (not existing->is_declaration())
+            return error("redefinition of '" + name + "'");
+        bodies_.emplace_back(&func, existing);
+    }
+    values_[&func] = existing;
+    return true;
+}
+
+void Linker::clone_body(Function &from, Function *to) {
+    auto dst_arg = to->get_args().begin();
+    for (auto &src_arg : from.get_args()) {
+        values_[&src_arg] = &*dst_arg;
+        if (not src_arg.get_name().empty()) {
+            dst_arg->set_name(src_arg.get_name());
+            to->reserve_name(src_arg.get_name());
+        }
+        ++dst_arg;
+    }
+    for (auto &bb : from.get_basic_blocks()) {
+        auto new_bb = BasicBlock::create(dst_, "", to);
+        if (not bb.get_name().empty()) {
+            new_bb->set_name(bb.get_name());
+            to->reserve_name(bb.get_name());
+        }
+        values_[&bb] = new_bb;
+    }
+
+    std::vector<Value *> operands;
+    for (auto &bb : from.get_basic_blocks()) {
+        auto new_bb = cast<BasicBlock>(values_[&bb]);
+        for (auto &instr : bb.get_instructions()) {
+            operands.clear();
+            for (auto op : instr.get_operands())
+                operands.push_back(map_value(op));
+            auto new_instr =
+                Instruction::create(instr.get_instr_type(),
+                                    map_type(instr.get_type()), operands,
+                                    new_bb);
+            assert(new_instr && "instruction does not survive linking");
+            if (not instr.get_name().empty()) {
+                new_instr->set_name(instr.get_name());
+                to->reserve_name(instr.get_name());
+            }
+            values_[&instr] = new_instr;
+            auto it = forward_refs_.find(&instr);
+            if (it != forward_refs_.end()) {
+                it->second->replace_all_use_with(new_instr);
+                forward_refs_.erase(it);
+            }
+        }
+    }
+    assert(forward_refs_.empty() && "use of an instruction never defined");
+
+    // keep the predecessor order, which decides the order of phi operands
+    // added by later passes
+    for (auto &bb : from.get_basic_blocks()) {
+        BasicBlock::BBList preds;
+        for (auto pred : bb.get_pre_basic_blocks())
+            preds.push_back(cast<BasicBlock>(values_[pred]));
+        cast<BasicBlock>(values_[&bb])->reorder_pre_basic_blocks(preds);
+    }
+}
+
+bool Linker::link(std::string &err) {
+    for (auto &func : dst_->get_functions())
+        symbols_[func.get_name()] = &func;
+    for (auto &global : dst_->get_global_variable())
+        symbols_[global.get_name()] = &global;
+
+    // bind every symbol before cloning, so that bodies may refer to any
+    for (auto &global : src_->get_global_variable())
+        if (not link_global(global))
+            break;
+    if (err_.empty())
+        for (auto &func : src_->get_functions())
+            if (not link_function(func))
+                break;
+    if (err_.empty())
+        for (auto &[from, to] : bodies_)
+            clone_body(*from, to);
+
+    err = err_;
+    return err_.empty();
+}
+
+} // namespace
+
+bool link_modules(Module *dst, Module *src, std::string &err) {
+    return Linker(dst, src).link(err);
+}
@@ -2,6 +2,7 @@
 #include "Function.hpp"
 #include "GlobalVariable.hpp"
 
+#include <llvm/Support/raw_ostream.h>
 #include <memory>
 #include <string>
 
@@ -26,27 +27,28 @@ PointerType *Module::get_float_ptr_type() {
 }
 
 PointerType *Module::get_pointer_type(Type *contained) {
-    if (pointer_map_.find(contained) == pointer_map_.end()) {
-        pointer_map_[contained] = std::make_unique<PointerType>(contained);
-    }
-    return pointer_map_[contained].get();
+    auto &slot = pointer_map_[contained];
+    if (not slot)
+        slot = std::make_unique<PointerType>(contained);
+    return slot.get();
 }
 
 ArrayType *Module::get_array_type(Type *contained, unsigned num_elements) {
-    if (array_map_.find({contained, num_elements}) == array_map_.end()) {
-        array_map_[{contained, num_elements}] =
-            std::make_unique<ArrayType>(contained, num_elements);
-    }
-    return array_map_[{contained, num_elements}].get();
+    auto &slot = array_map_[{contained, num_elements}];
+    if (not slot)
+        slot = std::make_unique<ArrayType>(contained, num_elements);
+    return slot.get();
 }
 
 FunctionType *Module::get_function_type(Type *retty,
                                         std::vector<Type *> &args) {
-    if (not function_map_.count({retty, args})) {
-        function_map_[{retty, args}] =
-            std::make_unique<FunctionType>(retty, args);
+    FunctionTypeKeyInfo::KeyTy key(retty, args);
+    auto insertion = function_set_.insert_as(nullptr, key);
+    if (insertion.second) {
+        function_types_.push_back(std::make_unique<FunctionType>(retty, args));
+        *insertion.first = function_types_.back().get();
     }
-    return function_map_[{retty, args}].get();
+    return *insertion.first;
 }
 
 void Module::add_function(Function *f) { function_list_.push_back(f); }
@@ -65,16 +67,22 @@ void Module::set_print_name() {
     return;
 }
 
-std::string Module::print() {
+void Module::print(llvm::raw_ostream &os) {
     set_print_name();
-    std::string module_ir;
     for (auto &global_val : this->global_list_) {
-        module_ir += global_val.print();
-        module_ir += "\n";
+        global_val.print(os);
+        os << '\n';
     }
     for (auto &func : this->function_list_) {
-        module_ir += func.print();
-        module_ir += "\n";
+        func.print(os);
+        os << '\n';
     }
-    return module_ir;
+}
+
+std::string Module::print() {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    print(os);
+    os.flush();
+    return str;
 }
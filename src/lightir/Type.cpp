@@ -1,8 +1,8 @@
 #include "Type.hpp"
 #include "Module.hpp"
 
-#include <array>
 #include <cassert>
+#include <llvm/Support/raw_ostream.h>
 #include <stdexcept>
 
 Type::Type(TypeID tid, Module *m) {
@@ -59,55 +59,54 @@ unsigned Type::get_size() const {
     assert(false && "unreachable");
 }
 
-std::string Type::print() const {
-    std::string type_ir;
+void Type::print(llvm::raw_ostream &os) const {
     switch (this->get_type_id()) {
     case VoidTyID:
-        type_ir += "void";
+        os << "void";
         break;
     case LabelTyID:
-        type_ir += "label";
+        os << "label";
         break;
     case IntegerTyID:
-        type_ir += "i";
-        type_ir += std::to_string(
-            static_cast<const IntegerType *>(this)->get_num_bits());
+        os << 'i' << static_cast<const IntegerType *>(this)->get_num_bits();
         break;
-    case FunctionTyID:
-        type_ir +=
-            static_cast<const FunctionType *>(this)->get_return_type()->print();
-        type_ir += " (";
-        for (unsigned i = 0;
-             i < static_cast<const FunctionType *>(this)->get_num_of_args();
-             i++) {
+    case FunctionTyID: {
+        auto func_ty = static_cast<const FunctionType *>(this);
+        func_ty->get_return_type()->print(os);
+        os << " (";
+        for (unsigned i = 0; i < func_ty->get_num_of_args(); i++) {
             if (i)
-                type_ir += ", ";
-            type_ir += static_cast<const FunctionType *>(this)
-                           ->get_param_type(i)
-                           ->print();
+                os << ", ";
+            func_ty->get_param_type(i)->print(os);
         }
-        type_ir += ")";
+        os << ')';
         break;
+    }
     case PointerTyID:
-        type_ir += this->get_pointer_element_type()->print();
-        type_ir += "*";
+        this->get_pointer_element_type()->print(os);
+        os << '*';
         break;
-    case ArrayTyID:
-        type_ir += "[";
-        type_ir += std::to_string(
-            static_cast<const ArrayType *>(this)->get_num_of_elements());
-        type_ir += " x ";
-        type_ir +=
-            static_cast<const ArrayType *>(this)->get_element_type()->print();
-        type_ir += "]";
+    case ArrayTyID: {
+        auto array_ty = static_cast<const ArrayType *>(this);
+        os << '[' << array_ty->get_num_of_elements() << " x ";
+        array_ty->get_element_type()->print(os);
+        os << ']';
         break;
+    }
     case FloatTyID:
-        type_ir += "float";
+        os << "float";
         break;
     default:
         break;
     }
-    return type_ir;
+}
+
+std::string Type::print() const {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    print(os);
+    os.flush();
+    return str;
 }
 
 IntegerType::IntegerType(unsigned num_bits, Module *m)
@@ -116,7 +115,7 @@ IntegerType::IntegerType(unsigned num_bits, Module *m)
 unsigned IntegerType::get_num_bits() const { return num_bits_; }
 
 FunctionType::FunctionType(Type *result, std::vector<Type *> params)
-    : Type(Type::FunctionTyID, nullptr) {
+    : Type(Type::FunctionTyID, result->get_module()) {
     assert(is_valid_return_type(result) && "Invalid return type for function!");
     result_ = result;
 
@@ -164,12 +163,12 @@ ArrayType *ArrayType::get(Type *contained, unsigned num_elements) {
 
 PointerType::PointerType(Type *contained)
     : Type(Type::PointerTyID, contained->get_module()), contained_(contained) {
-    static const std::array allowed_elem_type = {
-        Type::IntegerTyID, Type::FloatTyID, Type::ArrayTyID, Type::PointerTyID};
-    auto elem_type_id = contained->get_type_id();
-    assert(std::find(allowed_elem_type.begin(), allowed_elem_type.end(),
-                     elem_type_id) != allowed_elem_type.end() &&
-           "Not allowed type for pointer");
+    assert(is_valid_element_type(contained) && "Not allowed type for pointer");
+}
+
+bool PointerType::is_valid_element_type(Type *ty) {
+    return ty->is_integer_type() || ty->is_float_type() ||
+           ty->is_array_type() || ty->is_pointer_type();
 }
 
 PointerType *PointerType::get(Type *contained) {
@@ -1,40 +1,41 @@
 #include "User.hpp"
+#include "Instruction.hpp"
 
 #include <cassert>
 
 void User::set_operand(unsigned i, Value *v) {
     assert(i < operands_.size() && "set_operand out of index");
-    if (operands_[i]) { // old operand
-        operands_[i]->remove_use(this, i);
-    }
-    if (v) { // new operand
-        v->add_use(this, i);
-    }
-    operands_[i] = v;
+    auto old = operands_[i].get();
+    operands_[i].set(v);
+    if (old != v and isa<BranchInst>(this))
+        cast<BranchInst>(this)->replace_target(old, v);
 }
 
 void User::add_operand(Value *v) {
     assert(v != nullptr && "bad use: add_operand(nullptr)");
-    v->add_use(this, operands_.size());
-    operands_.push_back(v);
+    operands_.emplace_back(this, operands_.size());
+    operands_.back().set(v);
 }
 
 void User::remove_all_operands() {
-    for (unsigned i = 0; i != operands_.size(); ++i) {
-        if (operands_[i])
-            operands_[i]->remove_use(this, i);
+    // a branch drops the CFG edges to its targets along with them
+    if (isa<BranchInst>(this)) {
+        for (auto op : get_operands())
+            cast<BranchInst>(this)->replace_target(op, nullptr);
     }
     operands_.clear();
 }
 
 void User::remove_operand(unsigned idx) {
     assert(idx < operands_.size() && "remove_operand out of index");
-    // influence on other operands
+    auto old = operands_[idx].get();
+    // influence on other operands: shift them one slot down, each relink is
+    // O(1) thanks to the intrusive use list
     for (unsigned i = idx + 1; i < operands_.size(); ++i) {
-        operands_[i]->remove_use(this, i);
-        operands_[i]->add_use(this, i - 1);
+        operands_[i - 1].set(operands_[i].get());
     }
     // remove the designated operand
-    operands_[idx]->remove_use(this, idx);
-    operands_.erase(operands_.begin() + idx);
+    operands_.pop_back();
+    if (isa<BranchInst>(this))
+        cast<BranchInst>(this)->replace_target(old, nullptr);
 }
@@ -1,43 +1,94 @@
 #include "Value.hpp"
+#include "Module.hpp"
 #include "Type.hpp"
 #include "User.hpp"
 
 #include <cassert>
+#include <llvm/Support/raw_ostream.h>
 
-bool Value::set_name(std::string name) {
-    if (name_ == "") {
-        name_ = name;
-        return true;
-    }
-    return false;
+Use::Use(Use &&other) noexcept
+    : val_(other.val_), arg_no_(other.arg_no_), value_(other.value_),
+      prev_(other.prev_), next_(other.next_) {
+    if (value_ == nullptr)
+        return;
+    // redirect the neighbours to the new location
+    if (prev_)
+        prev_->next_ = this;
+    else
+        value_->use_head_ = this;
+    if (next_)
+        next_->prev_ = this;
+    else
+        value_->use_tail_ = this;
+    other.value_ = nullptr;
+    other.prev_ = other.next_ = nullptr;
+}
+
+void Use::set(Value *v) {
+    if (value_)
+        unlink();
+    value_ = v;
+    if (v == nullptr)
+        return;
+    prev_ = v->use_tail_;
+    next_ = nullptr;
+    if (prev_)
+        prev_->next_ = this;
+    else
+        v->use_head_ = this;
+    v->use_tail_ = this;
 }
 
-void Value::add_use(User *user, unsigned arg_no) {
-    use_list_.emplace_back(user, arg_no);
-};
+void Use::unlink() {
+    if (prev_)
+        prev_->next_ = next_;
+    else
+        value_->use_head_ = next_;
+    if (next_)
+        next_->prev_ = prev_;
+    else
+        value_->use_tail_ = prev_;
+    value_ = nullptr;
+    prev_ = next_ = nullptr;
+}
+
+Value::Value(ValueID vid, Type *ty, const std::string &name)
+    : vid_(vid), type_(ty),
+      name_(ty->get_module()->get_string_pool().intern(name)) {}
+
+std::string Value::print() {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    print(os);
+    os.flush();
+    return str;
+}
 
-void Value::remove_use(User *user, unsigned arg_no) {
-    auto target_use = Use(user, arg_no);
-    use_list_.remove_if([&](const Use &use) { return use == target_use; });
+bool Value::set_name(const std::string &name) {
+    if (name_->empty()) {
+        name_ = type_->get_module()->get_string_pool().intern(name);
+        return true;
+    }
+    return false;
 }
 
 void Value::replace_all_use_with(Value *new_val) {
     if (this == new_val)
         return;
-    while (use_list_.size()) {
-        auto use = use_list_.begin();
+    while (use_head_) {
+        auto use = use_head_;
         use->val_->set_operand(use->arg_no_, new_val);
     }
 }
 
-void Value::replace_use_with_if(Value *new_val,
-                                std::function<bool(Use)> should_replace) {
+void Value::replace_use_with_if(
+    Value *new_val, std::function<bool(const Use &)> should_replace) {
     if (this == new_val)
         return;
-    for (auto iter = use_list_.begin(); iter != use_list_.end();) {
-        auto use = *iter++;
-        if (not should_replace(use))
-            continue;
-        use.val_->set_operand(use.arg_no_, new_val);
+    for (auto use = use_head_; use;) {
+        auto next = use->get_next();
+        if (should_replace(*use))
+            use->val_->set_operand(use->arg_no_, new_val);
+        use = next;
     }
 }
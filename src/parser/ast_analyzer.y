@@ -0,0 +1,438 @@
+/* The grammar of Cminus-f. The actions build the AST of ast.hpp for
+   parse_ast(). When ctx->tree is set, as in parse(), they also build the
+   syntax tree printed by the parser of lab 1. The tree node of each symbol
+   is kept as its location, so that the semantic values are those of the
+   AST alone. */
+
+%require "3.2"
+%language "c++"
+%define api.parser.class {ASTParser}
+%define api.value.type variant
+%define parse.assert
+%locations
+%define api.location.type {syntax_tree_node *}
+
+%param {parse_context *ctx} {AST &ast}
+%parse-param {ASTProgram *&root}
+
+%code requires {
+    #include "ast.hpp"
+    #include "cminus_grammar.h"
+
+    // the location of a rule is only set by its action
+    #define YYLLOC_DEFAULT(Current, Rhs, N) ((Current) = nullptr)
+}
+
+%code {
+    #include <initializer_list>
+    #include <iostream>
+    #include <iterator>
+
+    // yyparse() takes its tokens from whichever lexer ctx uses
+    static int next_token(yy::ASTParser::semantic_type *lval,
+                          yy::ASTParser::location_type *lloc,
+                          parse_context *ctx, AST &ast);
+    #define yylex next_token
+
+    // the syntax tree node of a rule, nullptr unless ctx->tree is set
+    static syntax_tree_node *
+    tree_node(parse_context *ctx, int kind,
+              std::initializer_list<syntax_tree_node *> children);
+
+    static CminusType var_type(CminusType type) {
+        // like AST::transform_node_iter(), variables are never void
+        return type == TYPE_INT ? TYPE_INT : TYPE_FLOAT;
+    }
+}
+
+/* Declared in the order of enum cminus_token, so that the parser gives the
+   same kind to every token as the lexers. */
+%token ERROR
+%token <std::string_view> ID
+%token ADD SUB MUL DIV GT GEQ LT LEQ EQ NEQ ASSIGN // Operators
+%token <std::string> INTEGER FLOATPOINT // Literal values
+%token INT FLOAT VOID IF ELSE WHILE RETURN  // C keywords
+%token SEMICOLON COMMA LPAREN RPAREN LBRACKET RBRACKET LBRACE RBRACE // Other symbols: ; , ( ) [ ] { }
+
+%type <std::vector<ASTDeclaration *>> declaration-list
+%type <ASTDeclaration *> declaration
+%type <ASTVarDeclaration *> var-declaration
+%type <CminusType> type-specifier
+%type <ASTFunDeclaration *> fun-declaration
+%type <std::vector<ASTParam *>> params param-list
+%type <ASTParam *> param
+%type <ASTCompoundStmt *> compound-stmt
+%type <std::vector<ASTVarDeclaration *>> local-declarations
+%type <std::vector<ASTStatement *>> statement-list
+%type <ASTStatement *> statement expression-stmt selection-stmt iteration-stmt return-stmt
+%type <ASTExpression *> expression
+%type <ASTVar *> var
+%type <ASTSimpleExpression *> simple-expression
+%type <RelOp> relop
+%type <ASTAdditiveExpression *> additive-expression
+%type <AddOp> addop
+%type <ASTTerm *> term
+%type <MulOp> mulop
+%type <ASTFactor *> factor
+%type <ASTNum *> integer float
+%type <ASTCall *> call
+%type <std::vector<ASTExpression *>> args arg-list
+
+%start program
+
+%%
+
+program: declaration-list {
+        root = ast.create<ASTProgram>();
+        root->declarations = ast.create_list($1);
+        @$ = tree_node(ctx, NODE_PROGRAM, {@1});
+        if (ctx->tree)
+            ctx->tree->root = @$;
+    };
+declaration-list: declaration-list declaration { $$ = std::move($1); $$.push_back($2); @$ = tree_node(ctx, NODE_DECLARATION_LIST, {@1, @2}); }
+    | declaration { $$.push_back($1); @$ = tree_node(ctx, NODE_DECLARATION_LIST, {@1}); };
+declaration: var-declaration { $$ = $1; @$ = tree_node(ctx, NODE_DECLARATION, {@1}); }
+    | fun-declaration { $$ = $1; @$ = tree_node(ctx, NODE_DECLARATION, {@1}); };
+var-declaration: type-specifier ID SEMICOLON {
+        $$ = ast.create<ASTVarDeclaration>();
+        $$->type = var_type($1);
+        $$->id = $2;
+        @$ = tree_node(ctx, NODE_VAR_DECLARATION, {@1, @2, @3});
+    }
+    | type-specifier ID LBRACKET INTEGER RBRACKET SEMICOLON {
+        $$ = ast.create<ASTVarDeclaration>();
+        $$->type = var_type($1);
+        $$->id = $2;
+        $$->num = ast.create<ASTNum>();
+        $$->num->type = TYPE_INT;
+        $$->num->i_val = std::stoi($4);
+        @$ = tree_node(ctx, NODE_VAR_DECLARATION, {@1, @2, @3, @4, @5, @6});
+    };
+type-specifier: INT { $$ = TYPE_INT; @$ = tree_node(ctx, NODE_TYPE_SPECIFIER, {@1}); }
+    | FLOAT { $$ = TYPE_FLOAT; @$ = tree_node(ctx, NODE_TYPE_SPECIFIER, {@1}); }
+    | VOID { $$ = TYPE_VOID; @$ = tree_node(ctx, NODE_TYPE_SPECIFIER, {@1}); };
+fun-declaration: type-specifier ID LPAREN params RPAREN compound-stmt {
+        $$ = ast.create<ASTFunDeclaration>();
+        $$->type = $1;
+        $$->id = $2;
+        $$->params = ast.create_list($4);
+        $$->compound_stmt = $6;
+        @$ = tree_node(ctx, NODE_FUN_DECLARATION, {@1, @2, @3, @4, @5, @6});
+    };
+params: param-list { $$ = std::move($1); @$ = tree_node(ctx, NODE_PARAMS, {@1}); }
+    | VOID { @$ = tree_node(ctx, NODE_PARAMS, {@1}); };
+param-list: param-list COMMA param { $$ = std::move($1); $$.push_back($3); @$ = tree_node(ctx, NODE_PARAM_LIST, {@1, @2, @3}); }
+    | param { $$.push_back($1); @$ = tree_node(ctx, NODE_PARAM_LIST, {@1}); };
+param: type-specifier ID {
+        $$ = ast.create<ASTParam>();
+        $$->type = var_type($1);
+        $$->id = $2;
+        $$->isarray = false;
+        @$ = tree_node(ctx, NODE_PARAM, {@1, @2});
+    }
+    | type-specifier ID LBRACKET RBRACKET {
+        $$ = ast.create<ASTParam>();
+        $$->type = var_type($1);
+        $$->id = $2;
+        $$->isarray = true;
+        @$ = tree_node(ctx, NODE_PARAM, {@1, @2, @3, @4});
+    };
+compound-stmt: LBRACE local-declarations statement-list RBRACE {
+        $$ = ast.create<ASTCompoundStmt>();
+        $$->local_declarations = ast.create_list($2);
+        $$->statement_list = ast.create_list($3);
+        @$ = tree_node(ctx, NODE_COMPOUND_STMT, {@1, @2, @3, @4});
+    };
+local-declarations: local-declarations var-declaration { $$ = std::move($1); $$.push_back($2); @$ = tree_node(ctx, NODE_LOCAL_DECLARATIONS, {@1, @2}); }
+    | { @$ = tree_node(ctx, NODE_LOCAL_DECLARATIONS, {}); };
+statement-list: statement-list statement { $$ = std::move($1); $$.push_back($2); @$ = tree_node(ctx, NODE_STATEMENT_LIST, {@1, @2}); }
+    | { @$ = tree_node(ctx, NODE_STATEMENT_LIST, {}); };
+statement: expression-stmt { $$ = $1; @$ = tree_node(ctx, NODE_STATEMENT, {@1}); }
+    | compound-stmt { $$ = $1; @$ = tree_node(ctx, NODE_STATEMENT, {@1}); }
+    | selection-stmt { $$ = $1; @$ = tree_node(ctx, NODE_STATEMENT, {@1}); }
+    | iteration-stmt { $$ = $1; @$ = tree_node(ctx, NODE_STATEMENT, {@1}); }
+    | return-stmt { $$ = $1; @$ = tree_node(ctx, NODE_STATEMENT, {@1}); };
+expression-stmt: expression SEMICOLON {
+        auto stmt = ast.create<ASTExpressionStmt>();
+        stmt->expression = $1;
+        $$ = stmt;
+        @$ = tree_node(ctx, NODE_EXPRESSION_STMT, {@1, @2});
+    }
+    | SEMICOLON { $$ = ast.create<ASTExpressionStmt>(); @$ = tree_node(ctx, NODE_EXPRESSION_STMT, {@1}); };
+selection-stmt: IF LPAREN expression RPAREN statement {
+        auto stmt = ast.create<ASTSelectionStmt>();
+        stmt->expression = $3;
+        stmt->if_statement = $5;
+        $$ = stmt;
+        @$ = tree_node(ctx, NODE_SELECTION_STMT, {@1, @2, @3, @4, @5});
+    }
+    | IF LPAREN expression RPAREN statement ELSE statement {
+        auto stmt = ast.create<ASTSelectionStmt>();
+        stmt->expression = $3;
+        stmt->if_statement = $5;
+        stmt->else_statement = $7;
+        $$ = stmt;
+        @$ = tree_node(ctx, NODE_SELECTION_STMT, {@1, @2, @3, @4, @5, @6, @7});
+    };
+iteration-stmt: WHILE LPAREN expression RPAREN statement {
+        auto stmt = ast.create<ASTIterationStmt>();
+        stmt->expression = $3;
+        stmt->statement = $5;
+        $$ = stmt;
+        @$ = tree_node(ctx, NODE_ITERATION_STMT, {@1, @2, @3, @4, @5});
+    };
+return-stmt: RETURN SEMICOLON { $$ = ast.create<ASTReturnStmt>(); @$ = tree_node(ctx, NODE_RETURN_STMT, {@1, @2}); }
+    | RETURN expression SEMICOLON {
+        auto stmt = ast.create<ASTReturnStmt>();
+        stmt->expression = $2;
+        $$ = stmt;
+        @$ = tree_node(ctx, NODE_RETURN_STMT, {@1, @2, @3});
+    };
+expression: var ASSIGN expression {
+        auto expr = ast.create<ASTAssignExpression>();
+        expr->var = $1;
+        expr->expression = $3;
+        $$ = expr;
+        @$ = tree_node(ctx, NODE_EXPRESSION, {@1, @2, @3});
+    }
+    | simple-expression { $$ = $1; @$ = tree_node(ctx, NODE_EXPRESSION, {@1}); };
+var: ID {
+        $$ = ast.create<ASTVar>();
+        $$->id = $1;
+        @$ = tree_node(ctx, NODE_VAR, {@1});
+    }
+    | ID LBRACKET expression RBRACKET {
+        $$ = ast.create<ASTVar>();
+        $$->id = $1;
+        $$->expression = $3;
+        @$ = tree_node(ctx, NODE_VAR, {@1, @2, @3, @4});
+    };
+simple-expression: additive-expression relop additive-expression {
+        $$ = ast.create<ASTSimpleExpression>();
+        $$->additive_expression_l = $1;
+        $$->op = $2;
+        $$->additive_expression_r = $3;
+        @$ = tree_node(ctx, NODE_SIMPLE_EXPRESSION, {@1, @2, @3});
+    }
+    | additive-expression {
+        $$ = ast.create<ASTSimpleExpression>();
+        $$->additive_expression_l = $1;
+        @$ = tree_node(ctx, NODE_SIMPLE_EXPRESSION, {@1});
+    };
+relop: LEQ { $$ = OP_LE; @$ = tree_node(ctx, NODE_RELOP, {@1}); }
+    | LT { $$ = OP_LT; @$ = tree_node(ctx, NODE_RELOP, {@1}); }
+    | GT { $$ = OP_GT; @$ = tree_node(ctx, NODE_RELOP, {@1}); }
+    | GEQ { $$ = OP_GE; @$ = tree_node(ctx, NODE_RELOP, {@1}); }
+    | EQ { $$ = OP_EQ; @$ = tree_node(ctx, NODE_RELOP, {@1}); }
+    | NEQ { $$ = OP_NEQ; @$ = tree_node(ctx, NODE_RELOP, {@1}); };
+additive-expression: additive-expression addop term {
+        $$ = ast.create<ASTAdditiveExpression>();
+        $$->additive_expression = $1;
+        $$->op = $2;
+        $$->term = $3;
+        @$ = tree_node(ctx, NODE_ADDITIVE_EXPRESSION, {@1, @2, @3});
+    }
+    | term {
+        $$ = ast.create<ASTAdditiveExpression>();
+        $$->term = $1;
+        @$ = tree_node(ctx, NODE_ADDITIVE_EXPRESSION, {@1});
+    };
+addop: ADD { $$ = OP_PLUS; @$ = tree_node(ctx, NODE_ADDOP, {@1}); }
+    | SUB { $$ = OP_MINUS; @$ = tree_node(ctx, NODE_ADDOP, {@1}); };
+term: term mulop factor {
+        $$ = ast.create<ASTTerm>();
+        $$->term = $1;
+        $$->op = $2;
+        $$->factor = $3;
+        @$ = tree_node(ctx, NODE_TERM, {@1, @2, @3});
+    }
+    | factor {
+        $$ = ast.create<ASTTerm>();
+        $$->factor = $1;
+        @$ = tree_node(ctx, NODE_TERM, {@1});
+    };
+mulop: MUL { $$ = OP_MUL; @$ = tree_node(ctx, NODE_MULOP, {@1}); }
+    | DIV { $$ = OP_DIV; @$ = tree_node(ctx, NODE_MULOP, {@1}); };
+factor: LPAREN expression RPAREN { $$ = $2; @$ = tree_node(ctx, NODE_FACTOR, {@1, @2, @3}); }
+    | var { $$ = $1; @$ = tree_node(ctx, NODE_FACTOR, {@1}); }
+    | call { $$ = $1; @$ = tree_node(ctx, NODE_FACTOR, {@1}); }
+    | integer { $$ = $1; @$ = tree_node(ctx, NODE_FACTOR, {@1}); }
+    | float { $$ = $1; @$ = tree_node(ctx, NODE_FACTOR, {@1}); };
+integer: INTEGER {
+        $$ = ast.create<ASTNum>();
+        $$->type = TYPE_INT;
+        $$->i_val = std::stoi($1);
+        @$ = tree_node(ctx, NODE_INTEGER, {@1});
+    };
+float: FLOATPOINT {
+        $$ = ast.create<ASTNum>();
+        $$->type = TYPE_FLOAT;
+        $$->f_val = std::stof($1);
+        @$ = tree_node(ctx, NODE_FLOAT, {@1});
+    };
+call: ID LPAREN args RPAREN {
+        $$ = ast.create<ASTCall>();
+        $$->id = $1;
+        $$->args = ast.create_list($3);
+        @$ = tree_node(ctx, NODE_CALL, {@1, @2, @3, @4});
+    };
+args: arg-list { $$ = std::move($1); @$ = tree_node(ctx, NODE_ARGS, {@1}); }
+    | { @$ = tree_node(ctx, NODE_ARGS, {}); };
+arg-list: arg-list COMMA expression { $$ = std::move($1); $$.push_back($3); @$ = tree_node(ctx, NODE_ARG_LIST, {@1, @2, @3}); }
+    | expression { $$.push_back($1); @$ = tree_node(ctx, NODE_ARG_LIST, {@1}); };
+
+%%
+
+/// Report a syntax error at the last token read.
+void yy::ASTParser::error(const location_type &, const std::string &msg) {
+    std::cerr << "Error at line " << ctx->lines << ", column "
+              << ctx->pos_start << " to " << ctx->pos_end << ": " << msg
+              << std::endl;
+}
+
+/// Parse input from file `input_path` into an AST. If input_path is NULL,
+/// read from stdin. Exits on a syntax error, unless a syntax tree is built
+/// into tree as well; then the AST of a wrong input has no root.
+///
+/// It keeps no state between calls and may run in several threads at once.
+AST parse_ast(const char *input_path, bool fast_lexer, syntax_tree *tree) {
+    parse_context ctx = {};
+    ctx.tree = tree;
+    ctx.lines = ctx.pos_start = ctx.pos_end = 1;
+
+    FILE *in = stdin;
+    if (fast_lexer) {
+        ctx.fast_lex = fast_lexer_open(input_path);
+    } else if (input_path != NULL) {
+        in = fopen(input_path, "r");
+    }
+    if (fast_lexer ? ctx.fast_lex == NULL : in == NULL) {
+        fprintf(stderr, "[ERR] Open input file %s failed.\n",
+                input_path ? input_path : "<stdin>");
+        exit(1);
+    }
+    if (not fast_lexer) {
+        yylex_init_extra(&ctx, &ctx.scanner);
+        yyset_in(in, ctx.scanner);
+    }
+
+    AST ast(std::make_unique<Arena>());
+    int failed = yy::ASTParser(&ctx, ast, ast.root).parse();
+
+    if (fast_lexer) {
+        fast_lexer_close(ctx.fast_lex);
+    } else {
+        yylex_destroy(ctx.scanner);
+        if (in != stdin)
+            fclose(in);
+    }
+    if (failed and tree == nullptr)
+        exit(1);
+    return ast;
+}
+
+syntax_tree *parse(const char *input_path) {
+    auto tree = new_syntax_tree();
+    parse_ast(input_path, false, tree);
+    return tree;
+}
+
+syntax_tree *parse_fast(const char *input_path) {
+    auto tree = new_syntax_tree();
+    parse_ast(input_path, true, tree);
+    return tree;
+}
+
+#undef yylex
+/// Fetch the next token for the parser from whichever lexer is in use.
+static int next_token(yy::ASTParser::semantic_type *lval,
+                      yy::ASTParser::location_type *lloc,
+                      parse_context *ctx, AST &ast) {
+    const char *text;
+    int len, type;
+    if (ctx->fast_lex) {
+        fast_token tok;
+        type = fast_lexer_next(ctx->fast_lex, &tok);
+        ctx->lines = tok.line;
+        ctx->pos_start = tok.pos_start;
+        ctx->pos_end = tok.pos_end;
+        text = tok.text;
+        len = tok.len;
+    } else {
+        type = yylex(ctx->scanner);
+        text = yyget_text(ctx->scanner);
+        len = yyget_leng(ctx->scanner);
+    }
+
+    // token kinds of the C code, see the %token declarations above
+    static_assert(int(yy::ASTParser::token::ID) == int(ID));
+    static_assert(int(yy::ASTParser::token::RBRACE) == int(RBRACE));
+    if (type == ID)
+        lval->emplace<std::string_view>(ast.create_id(std::string_view(text, len)));
+    else if (type == INTEGER or type == FLOATPOINT)
+        lval->emplace<std::string>(text, len);
+    *lloc = nullptr;
+    if (type and ctx->tree) {
+        *lloc = new_syntax_tree_token(ctx->tree, text, len);
+        (*lloc)->kind = type;
+    }
+    return type;
+}
+
+/// Names of the node kinds, as printed by print_syntax_tree().
+static const char *const node_names[] = {
+    nullptr,
+    "program",
+    "declaration-list",
+    "declaration",
+    "var-declaration",
+    "type-specifier",
+    "fun-declaration",
+    "params",
+    "param-list",
+    "param",
+    "compound-stmt",
+    "local-declarations",
+    "statement-list",
+    "statement",
+    "expression-stmt",
+    "selection-stmt",
+    "iteration-stmt",
+    "return-stmt",
+    "expression",
+    "var",
+    "simple-expression",
+    "relop",
+    "additive-expression",
+    "addop",
+    "term",
+    "mulop",
+    "factor",
+    "integer",
+    "float",
+    "call",
+    "args",
+    "arg-list",
+    "epsilon",
+};
+static_assert(std::size(node_names) == NODE_EPSILON + 1,
+              "one name for each enum syntax_node_kind");
+
+/// A node of the syntax tree for the symbols of a rule, which are in
+/// children. A rule without symbols gets an epsilon node as its child.
+static syntax_tree_node *
+tree_node(parse_context *ctx, int kind,
+          std::initializer_list<syntax_tree_node *> children) {
+    if (ctx->tree == nullptr)
+        return nullptr;
+    if (children.size() == 0) {
+        auto epsilon = new_syntax_tree_node(ctx->tree, "epsilon", 0);
+        epsilon->kind = NODE_EPSILON;
+        return tree_node(ctx, kind, {epsilon});
+    }
+
+    auto p = new_syntax_tree_node(ctx->tree, node_names[kind], children.size());
+    p->kind = kind;
+    std::copy(children.begin(), children.end(), p->children);
+    return p;
+}
@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fast_lexer.h"
+#include "cminus_grammar.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FAST_LEXER_X86 1
+#include <immintrin.h>
+#endif
+
+/*****************字符分类  begin*****************/
+
+// Byte classes the scanner skips over in bulk.
+enum char_class {
+    CLASS_BLANK, // ' ' and '\t', newlines are counted one by one
+    CLASS_ALPHA, // [a-zA-Z]
+    CLASS_DIGIT, // [0-9]
+};
+
+// Return the first byte in [p, end) that is not in cls, or end.
+typedef const char *(*span_fn)(const char *p, const char *end, int cls);
+// Count the newlines in [p, end).
+typedef int (*count_fn)(const char *p, const char *end);
+
+static int in_class(unsigned char c, int cls) {
+    switch (cls) {
+    case CLASS_BLANK:
+        return c == ' ' || c == '\t';
+    case CLASS_ALPHA:
+        return (unsigned)((c | 0x20) - 'a') < 26;
+    default:
+        return (unsigned)(c - '0') < 10;
+    }
+}
+
+static const char *span_scalar(const char *p, const char *end, int cls) {
+    while (p < end && in_class(*p, cls))
+        p++;
+    return p;
+}
+
+static int count_scalar(const char *p, const char *end) {
+    int n = 0;
+    for (; p < end; p++)
+        n += *p == '\n';
+    return n;
+}
+
+#if defined(FAST_LEXER_X86) && defined(__SSE2__)
+// Bytes in [lo, lo + n): shift the range down to start at -128, then a single
+// signed compare does the job.
+static __m128i in_range_sse2(__m128i v, char lo, char n) {
+    v = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - lo)));
+    return _mm_cmplt_epi8(v, _mm_set1_epi8((char)(-128 + n)));
+}
+
+static __m128i classify_sse2(__m128i v, int cls) {
+    switch (cls) {
+    case CLASS_BLANK:
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                            _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    case CLASS_ALPHA:
+        // folding to lower case only maps letters into [a-z]
+        return in_range_sse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26);
+    default:
+        return in_range_sse2(v, '0', 10);
+    }
+}
+
+static const char *span_sse2(const char *p, const char *end, int cls) {
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        unsigned mask = ~_mm_movemask_epi8(classify_sse2(v, cls)) & 0xffff;
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return span_scalar(p, end, cls);
+}
+
+static int count_sse2(const char *p, const char *end) {
+    int n = 0;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        n += __builtin_popcount(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    }
+    return n + count_scalar(p, end);
+}
+#endif
+
+#ifdef FAST_LEXER_X86
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static __m256i in_range_avx2(__m256i v, char lo, char n) {
+    v = _mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + n)), v);
+}
+
+AVX2 static __m256i classify_avx2(__m256i v, int cls) {
+    switch (cls) {
+    case CLASS_BLANK:
+        return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                               _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    case CLASS_ALPHA:
+        return in_range_avx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a',
+                             26);
+    default:
+        return in_range_avx2(v, '0', 10);
+    }
+}
+
+AVX2 static const char *span_avx2(const char *p, const char *end, int cls) {
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(classify_avx2(v, cls));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return span_scalar(p, end, cls);
+}
+
+AVX2 static int count_avx2(const char *p, const char *end) {
+    int n = 0;
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        n += __builtin_popcount((unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+    }
+    return n + count_scalar(p, end);
+}
+
+#undef AVX2
+#endif
+
+/*****************字符分类  end*****************/
+
+struct _fast_lexer {
+    char *buf;
+    size_t map_size; // non-zero if buf is mapped, otherwise buf is malloc'd
+    const char *cur;
+    const char *end;
+
+    span_fn span;
+    count_fn count;
+
+    // same meaning as in lexical_analyzer.l
+    int lines;
+    int pos_start;
+    int pos_end;
+};
+
+static void select_scanner(fast_lexer *lexer) {
+    lexer->span = span_scalar;
+    lexer->count = count_scalar;
+#ifdef FAST_LEXER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        lexer->span = span_avx2;
+        lexer->count = count_avx2;
+        return;
+    }
+#endif
+#if defined(FAST_LEXER_X86) && defined(__SSE2__)
+    lexer->span = span_sse2;
+    lexer->count = count_sse2;
+#endif
+}
+
+int fast_lexer_use_scanner(fast_lexer *lexer, const char *name) {
+    if (!strcmp(name, "scalar")) {
+        lexer->span = span_scalar;
+        lexer->count = count_scalar;
+        return 0;
+    }
+#ifdef FAST_LEXER_X86
+    if (!strcmp(name, "avx2") && __builtin_cpu_supports("avx2")) {
+        lexer->span = span_avx2;
+        lexer->count = count_avx2;
+        return 0;
+    }
+#endif
+#if defined(FAST_LEXER_X86) && defined(__SSE2__)
+    if (!strcmp(name, "sse2")) {
+        lexer->span = span_sse2;
+        lexer->count = count_sse2;
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+// Read all of fd into a malloc'd buffer, for pipes and other unmappable input.
+static int read_all(int fd, fast_lexer *lexer) {
+    size_t size = 0, cap = 4096;
+    char *buf = malloc(cap);
+    if (!buf)
+        return -1;
+    for (;;) {
+        if (size == cap) {
+            char *bigger = realloc(buf, cap *= 2);
+            if (!bigger) {
+                free(buf);
+                return -1;
+            }
+            buf = bigger;
+        }
+        ssize_t n = read(fd, buf + size, cap - size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            int err = errno;
+            free(buf);
+            errno = err;
+            return -1;
+        }
+        if (n == 0)
+            break;
+        size += n;
+    }
+    lexer->buf = buf;
+    lexer->cur = buf;
+    lexer->end = buf + size;
+    return 0;
+}
+
+fast_lexer *fast_lexer_open(const char *input_path) {
+    fast_lexer *lexer = calloc(1, sizeof(fast_lexer));
+    if (!lexer)
+        return NULL;
+    int fd = input_path ? open(input_path, O_RDONLY) : STDIN_FILENO;
+    if (fd < 0) {
+        free(lexer);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buf != MAP_FAILED) {
+            lexer->buf = buf;
+            lexer->map_size = st.st_size;
+            lexer->cur = buf;
+            lexer->end = lexer->cur + st.st_size;
+        }
+    }
+    int ok = lexer->map_size || read_all(fd, lexer) == 0;
+    int err = errno;
+    if (input_path)
+        close(fd);
+    if (!ok) {
+        free(lexer);
+        errno = err;
+        return NULL;
+    }
+
+    select_scanner(lexer);
+    lexer->lines = lexer->pos_start = lexer->pos_end = 1;
+    return lexer;
+}
+
+void fast_lexer_close(fast_lexer *lexer) {
+    if (!lexer)
+        return;
+    if (lexer->map_size)
+        munmap(lexer->buf, lexer->map_size);
+    else
+        free(lexer->buf);
+    free(lexer);
+}
+
+static int keyword_or_id(const char *s, int len) {
+    switch (len) {
+    case 2:
+        if (!memcmp(s, "if", 2))
+            return IF;
+        break;
+    case 3:
+        if (!memcmp(s, "int", 3))
+            return INT;
+        break;
+    case 4:
+        if (!memcmp(s, "else", 4))
+            return ELSE;
+        if (!memcmp(s, "void", 4))
+            return VOID;
+        break;
+    case 5:
+        if (!memcmp(s, "while", 5))
+            return WHILE;
+        if (!memcmp(s, "float", 5))
+            return FLOAT;
+        break;
+    case 6:
+        if (!memcmp(s, "return", 6))
+            return RETURN;
+        break;
+    }
+    return ID;
+}
+
+// Find the "*/" closing a comment whose body starts at p.
+static const char *find_comment_end(const char *p, const char *end) {
+    while (p < end) {
+        const char *star = memchr(p, '*', end - p);
+        if (!star || star + 1 == end)
+            return NULL;
+        if (star[1] == '/')
+            return star;
+        p = star + 1;
+    }
+    return NULL;
+}
+
+int fast_lexer_next(fast_lexer *lexer, fast_token *tok) {
+    const char *p = lexer->cur, *end = lexer->end;
+    const char *start = p;
+    int type = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == ' ' || c == '\t') {
+            // each blank is an unmatched character to the flex scanner
+            int n = lexer->span(p, end, CLASS_BLANK) - p;
+            lexer->pos_start = lexer->pos_end + n - 1;
+            lexer->pos_end += n;
+            p += n;
+            continue;
+        }
+        if (c == '\n') {
+            lexer->pos_start = lexer->pos_end = 1;
+            lexer->lines++;
+            p++;
+            continue;
+        }
+
+        start = p;
+        if (in_class(c, CLASS_ALPHA)) {
+            p = lexer->span(p + 1, end, CLASS_ALPHA);
+            type = keyword_or_id(start, p - start);
+            break;
+        }
+        // [0-9]+  [0-9]+\.  [0-9]*\.[0-9]+
+        if (in_class(c, CLASS_DIGIT) ||
+            (c == '.' && p + 1 < end && in_class(p[1], CLASS_DIGIT))) {
+            p = lexer->span(p, end, CLASS_DIGIT);
+            type = INTEGER;
+            if (p < end && *p == '.') {
+                p = lexer->span(p + 1, end, CLASS_DIGIT);
+                type = FLOATPOINT;
+            }
+            break;
+        }
+        if (c == '/' && p + 1 < end && p[1] == '*') {
+            // an unterminated comment is lexed as DIV MUL ..., like flex does
+            const char *close = find_comment_end(p + 2, end);
+            if (close) {
+                const char *after = close + 2;
+                int newlines = lexer->count(p, after);
+                lexer->pos_start = lexer->pos_end;
+                if (newlines) {
+                    const char *last = close;
+                    while (*last != '\n')
+                        last--;
+                    // lexical_analyzer.l restarts the column at 0 here
+                    lexer->lines += newlines;
+                    lexer->pos_end = after - last - 1;
+                } else {
+                    lexer->pos_end += after - p;
+                }
+                p = after;
+                continue;
+            }
+        }
+
+        p++;
+        switch (c) {
+        case '+': type = ADD; break;
+        case '-': type = SUB; break;
+        case '*': type = MUL; break;
+        case '/': type = DIV; break;
+        case ';': type = SEMICOLON; break;
+        case ',': type = COMMA; break;
+        case '(': type = LPAREN; break;
+        case ')': type = RPAREN; break;
+        case '[': type = LBRACKET; break;
+        case ']': type = RBRACKET; break;
+        case '{': type = LBRACE; break;
+        case '}': type = RBRACE; break;
+        case '>':
+            type = p < end && *p == '=' ? (p++, GEQ) : GT;
+            break;
+        case '<':
+            type = p < end && *p == '=' ? (p++, LEQ) : LT;
+            break;
+        case '=':
+            type = p < end && *p == '=' ? (p++, EQ) : ASSIGN;
+            break;
+        case '!':
+            if (p < end && *p == '=') {
+                p++;
+                type = NEQ;
+                break;
+            }
+            // fall through
+        default:
+            // no rule matches, skip the character
+            lexer->pos_start = lexer->pos_end;
+            lexer->pos_end++;
+            continue;
+        }
+        break;
+    }
+
+    if (type) {
+        lexer->pos_start = lexer->pos_end;
+        lexer->pos_end += p - start;
+    } else {
+        start = p;
+    }
+    lexer->cur = p;
+    tok->type = type;
+    tok->len = p - start;
+    tok->text = start;
+    tok->line = lexer->lines;
+    tok->pos_start = lexer->pos_start;
+    tok->pos_end = lexer->pos_end;
+    return type;
+}
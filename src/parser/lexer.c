@@ -1,41 +1,67 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
-#include<syntax_analyzer.h>
+#include "cminus_grammar.h"
+#include "fast_lexer.h"
 
-///
-extern int lines;
-extern int pos_start;
-extern int pos_end;
-
-///
-extern FILE *yyin;
-extern char *yytext;
-extern int yylex();
+/// Print the tokens of the hand-written lexer in the same format.
+/// scanner is NULL to let the lexer pick the fastest one.
+static int run_fast_lexer(const char *input_file, const char *scanner) {
+     fast_lexer *lexer = fast_lexer_open(input_file);
+     if (!lexer) {
+          fprintf(stderr, "cannot open file: %s\n", input_file);
+          return 1;
+     }
+     if (scanner && fast_lexer_use_scanner(lexer, scanner) != 0) {
+          fprintf(stderr, "scanner not available: %s\n", scanner);
+          fast_lexer_close(lexer);
+          return 2;
+     }
 
-// Mac-only hack.
-YYSTYPE yylval;
+     fast_token tok;
+     printf("%5s\t%10s\t%s\t%s\n", "Token", "Text", "Line", "Column (Start,End)");
+     while (fast_lexer_next(lexer, &tok)) {
+          printf("%-5d\t%10.*s\t%d\t(%d,%d)\n",
+                 tok.type, tok.len, tok.text,
+                 tok.line, tok.pos_start, tok.pos_end);
+     }
+     fast_lexer_close(lexer);
+     return 0;
+}
 
 ///
 int main(int argc, const char **argv) {
+     if (argc == 3 && strcmp(argv[1], "-fast-lexer") == 0) {
+          return run_fast_lexer(argv[2], NULL);
+     }
+     if (argc == 3 && strncmp(argv[1], "-fast-lexer=", 12) == 0) {
+          return run_fast_lexer(argv[2], argv[1] + 12);
+     }
      if (argc != 2) {
-          printf("usage: lexer input_file\n");
+          printf("usage: lexer [-fast-lexer[=scalar|sse2|avx2]] input_file\n");
           return 0;
      }
 
      const char *input_file = argv[1];
-     yyin = fopen(input_file, "r");
-     if (!yyin) {
+     FILE *in = fopen(input_file, "r");
+     if (!in) {
           fprintf(stderr, "cannot open file: %s\n", input_file);
           return 1;
      }
 
+     parse_context ctx = {NULL};
+     ctx.lines = ctx.pos_start = ctx.pos_end = 1;
+     yylex_init_extra(&ctx, &ctx.scanner);
+     yyset_in(in, ctx.scanner);
+
      int token;
      printf("%5s\t%10s\t%s\t%s\n", "Token", "Text", "Line", "Column (Start,End)");
-     while ((token = yylex())) {
+     while ((token = yylex(ctx.scanner))) {
           printf("%-5d\t%10s\t%d\t(%d,%d)\n",
-                 token, yytext,
-                 lines, pos_start, pos_end);
+                 token, yyget_text(ctx.scanner),
+                 ctx.lines, ctx.pos_start, ctx.pos_end);
      }
+     yylex_destroy(ctx.scanner);
+     fclose(in);
      return 0;
 }
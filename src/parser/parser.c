@@ -1,20 +1,29 @@
-#include "syntax_tree.h"
-extern syntax_tree *parse(const char*);
+#include <string.h>
+
+#include "cminus_grammar.h"
 
 int main(int argc, char *argv[])
 {
     syntax_tree *tree = NULL;
     const char *input = NULL;
+    const char *prog = argv[0];
+    int fast = 0;
 
+    // -fast-lexer: use the hand-written lexer instead of flex
+    if (argc >= 2 && strcmp(argv[1], "-fast-lexer") == 0) {
+        fast = 1;
+        argc--;
+        argv++;
+    }
     if (argc == 2) {
         input = argv[1];
     } else if(argc >= 3) {
-        printf("usage: %s <cminus_file>\n", argv[0]);
+        printf("usage: %s [-fast-lexer] <cminus_file>\n", prog);
         return 1;
     }
 
     // Call the syntax analyzer.
-    tree = parse(input);
+    tree = fast ? parse_fast(input) : parse(input);
     print_syntax_tree(stdout, tree);
     del_syntax_tree(tree);
     return 0;
@@ -1,6 +1,8 @@
 #include "DeadCode.hpp"
 #include "logging.hpp"
 
+#include <cassert>
+
 // 处理流程：两趟处理，mark 标记有用变量，sweep 删除无用指令
 void DeadCode::run() {
     bool changed{};
@@ -18,12 +20,14 @@ void DeadCode::run() {
 
 void DeadCode::mark(Function *func) {
     work_list.clear();
+    func->renumber();
     marked.clear();
+    marked.resize(func->get_num_instr_indices());
 
     for (auto &bb : func->get_basic_blocks()) {
         for (auto &ins : bb.get_instructions()) {
             if (is_critical(&ins)) {
-                marked[&ins] = true;
+                marked.set(ins.get_index());
                 work_list.push_back(&ins);
             }
         }
@@ -39,14 +43,15 @@ void DeadCode::mark(Function *func) {
 
 void DeadCode::mark(Instruction *ins) {
     for (auto op : ins->get_operands()) {
-        auto def = dynamic_cast<Instruction *>(op);
+        auto def = dyn_cast<Instruction>(op);
         if (def == nullptr)
             continue;
-        if (marked[def])
-            continue;
-        if (def->get_function() != ins->get_function())
+        // marked 按当前函数的指令编号索引, 操作数只能来自同一函数
+        assert(def->get_function() == ins->get_function() &&
+               "operand defined in another function");
+        if (marked.test(def->get_index()))
             continue;
-        marked[def] = true;
+        marked.set(def->get_index());
         work_list.push_back(def);
     }
 }
@@ -56,7 +61,7 @@ bool DeadCode::sweep(Function *func) {
     for (auto &bb : func->get_basic_blocks()) {
         for (auto it = bb.get_instructions().begin();
              it != bb.get_instructions().end();) {
-            if (marked[&*it]) {
+            if (marked.test(it->get_index())) {
                 ++it;
                 continue;
             } else {
@@ -77,8 +82,8 @@ bool DeadCode::sweep(Function *func) {
 bool DeadCode::is_critical(Instruction *ins) {
     // 对纯函数的无用调用也可以在删除之列
     if (ins->is_call()) {
-        auto call_inst = dynamic_cast<CallInst *>(ins);
-        auto callee = dynamic_cast<Function *>(call_inst->get_operand(0));
+        auto call_inst = cast<CallInst>(ins);
+        auto callee = cast<Function>(call_inst->get_operand(0));
         if (func_info->is_pure_function(callee))
             return false;
         return true;
@@ -1,4 +1,8 @@
 #include "Dominators.hpp"
+#include "DataFlow.hpp"
+#include "IRprinter.hpp"
+
+#include <vector>
 
 void Dominators::run() {
     for (auto& f_ : m_->get_functions()) {
@@ -18,58 +22,54 @@ void Dominators::run() {
     }
 }
 
+namespace {
+// 支配集: 前向数据流, meet 为交集, 块的输出为输入加上块自身
+struct DominatorSets {
+    using Domain = llvm::BitVector;
+    static constexpr auto direction = DataFlowDirection::Forward;
+
+    unsigned num_blocks;
+
+    Domain boundary() { return Domain(num_blocks); }
+    Domain top() { return Domain(num_blocks, true); }
+    void meet(Domain& lhs, const Domain& rhs) { lhs &= rhs; }
+    Domain transfer(BasicBlock* bb, const Domain& in) {
+        auto out = in;
+        out.set(bb->get_index());
+        return out;
+    }
+};
+}  // namespace
+
 void Dominators::create_idom(Function* f) {
     // DONE: 分析得到 f 中各个基本块的 immediate dominator
+    f->renumber();
+    DominatorSets problem{f->get_num_block_indices()};
+    DataFlowSolver<DominatorSets> solver(f, problem);
+    solver.solve();
+
+    // 不可达的块没有支配者, idom 保持为 nullptr
+    std::vector<BasicBlock*> blocks(f->get_num_block_indices());
+    for (auto bb : f->get_reverse_post_order()) {
+        blocks[bb->get_index()] = bb;
+    }
     auto entry = f->get_entry_block();
     idom[entry] = entry;
-    BasicBlock* newIdom = nullptr;
-    std::list<BasicBlock*> queue;
-    BBSet processed;
-    bool flag = true;  // Is changed
-    while (flag) {
-        flag = false;
-        queue.emplace_back(entry);
-        processed.clear();
-        while (!queue.empty()) {
-            auto cur = queue.front();
-            queue.pop_front();
-            if (!processed.insert(cur).second) {
-                continue;
-            }
-            for (auto succ : cur->get_succ_basic_blocks()) {
-                if (succ != nullptr) {
-                    queue.emplace_back(succ);
-                }
-            }
-            if (cur == entry) {
+    for (auto bb : f->get_reverse_post_order()) {
+        if (bb == entry) {
+            continue;
+        }
+        // 严格支配者构成一条链, 其中自身支配者最多的就是直接支配者
+        auto& doms = solver.get_block_exit(bb);
+        unsigned best_count = 0;
+        for (auto i : doms.set_bits()) {
+            if (i == bb->get_index()) {
                 continue;
             }
-            for (auto pred : cur->get_pre_basic_blocks()) {
-                if (processed.find(pred) != processed.end()) {
-                    newIdom = pred;
-                }
-            }
-            for (auto pred : cur->get_pre_basic_blocks()) {
-                if (idom[pred] == nullptr) {
-                    continue;
-                }
-                auto p1 = pred, p2 = newIdom;
-                while (p1 != p2) {
-                    if (bb_same(p1, p2)) {
-                        p1 = get_idom(p1);
-                    }
-                    while (bb_dom(p1, p2)) {
-                        p1 = get_idom(p1);
-                    }
-                    while (bb_dom(p2, p1)) {
-                        p2 = get_idom(p2);
-                    }
-                }
-                newIdom = p1;
-            }
-            if (idom[cur] != newIdom) {
-                flag = true;
-                idom[cur] = newIdom;
+            auto count = solver.get_block_exit(blocks[i]).count();
+            if (count > best_count) {
+                best_count = count;
+                idom[bb] = blocks[i];
             }
         }
     }
@@ -80,11 +80,17 @@ void Dominators::create_dominance_frontier(Function* f) {
     BasicBlock* cur = nullptr;
     auto end = f->get_basic_blocks().end();
     for (auto iter = f->get_basic_blocks().begin(); iter != end; iter++) {
-        auto pbs = (&*iter)->get_pre_basic_blocks();
+        auto &pbs = (&*iter)->get_pre_basic_blocks();
         if (pbs.size() < 2) {
             continue;
         }
+        if (idom[&*iter] == nullptr) {
+            continue;
+        }
         for (auto pred : pbs) {
+            if (idom[pred] == nullptr) {
+                continue;  // 来自不可达的块
+            }
             cur = pred;
             while (cur != idom[&*iter]) {
                 domFront[cur].insert(&*iter);
@@ -98,39 +104,36 @@ void Dominators::create_dom_tree_succ(Function* f) {
     // DONE: 计算基本块的后继
     auto end = f->get_basic_blocks().end();
     for (auto iter = f->get_basic_blocks().begin(); iter != end; iter++) {
-        if (&*iter != f->get_entry_block()) {
+        if (&*iter != f->get_entry_block() && idom[&*iter] != nullptr) {
             domSucc[idom[&*iter]].insert(&*iter);
         }
     }
 }
 
-bool Dominators::bb_same(BasicBlock* bb1, BasicBlock* bb2) {
-    // DONE: 比较基本块是否相等
-    if (bb1 == nullptr || bb2 == nullptr) {
-        return bb2 == nullptr;
-    }
-    auto p1 = bb1, p2 = bb2;
-    std::list<BasicBlock*> pb1, pb2;
-    while (!(pb1 = p1->get_pre_basic_blocks()).empty() && !(pb2 = p2->get_pre_basic_blocks()).empty()) {
-        p1 = pb1.front();
-        p2 = pb2.front();
-    }
-    pb1 = p1->get_pre_basic_blocks();
-    pb2 = p2->get_pre_basic_blocks();
-    return pb1.empty() && pb2.empty();
-}
-
-bool Dominators::bb_dom(BasicBlock* bb1, BasicBlock* bb2) {
-    // DONE: 比较基本块是否支配
-    if (bb1 == nullptr || bb2 == nullptr) {
-        return !(bb1 == nullptr);
-    }
-    auto p1 = bb1, p2 = bb2;
-    std::list<BasicBlock*> pb1, pb2;
-    while (!(pb1 = p1->get_pre_basic_blocks()).empty() && !(pb2 = p2->get_pre_basic_blocks()).empty()) {
-        p1 = pb1.front();
-        p2 = pb2.front();
+void Dominators::print(llvm::raw_ostream& os) {
+    for (auto& f : m_->get_functions()) {
+        if (f.is_declaration()) {
+            continue;
+        }
+        os << "define @" << f.get_name() << "\n";
+        for (auto& bb : f.get_basic_blocks()) {
+            os << "  ";
+            print_as_op(os, &bb, false);
+            os << ": idom ";
+            if (idom[&bb] == nullptr) {
+                os << "none";  // 不可达
+            } else {
+                print_as_op(os, idom[&bb], false);
+            }
+            os << ", frontier";
+            // domFront 按指针排序, 这里按布局顺序输出
+            for (auto& df : f.get_basic_blocks()) {
+                if (domFront[&bb].count(&df)) {
+                    os << " ";
+                    print_as_op(os, &df, false);
+                }
+            }
+            os << "\n";
+        }
     }
-    pb1 = p1->get_pre_basic_blocks();
-    return !pb1.empty();
 }
@@ -34,13 +34,13 @@ void Mem2Reg::generate_phi() {
         for (auto& ins : bb.get_instructions()) {  // 遍历基本块中的所有指令
             Value* lv = nullptr;
             if (ins.is_load()) {  // 如果是 load 指令
-                auto load = dynamic_cast<LoadInst*>(&ins);
+                auto load = cast<LoadInst>(&ins);
                 lv = load->get_lval();
             } else if (ins.is_store()) {  // 如果是 store 指令
-                auto store = dynamic_cast<StoreInst*>(&ins);
+                auto store = cast<StoreInst>(&ins);
                 lv = store->get_lval();
             } else if (ins.is_alloca()) {  // 如果是 alloca 指令
-                auto alloca = dynamic_cast<AllocaInst*>(&ins);
+                auto alloca = cast<AllocaInst>(&ins);
                 if (!alloca->get_alloca_type()->is_array_type()) {
                     varDef[alloca].emplace_back(&bb);  // 记录局部变量的定义
                 }
@@ -58,7 +58,7 @@ void Mem2Reg::generate_phi() {
             if (!ins.is_store()) {
                 continue;  // 如果不是 store 指令，跳过
             }
-            auto store = dynamic_cast<StoreInst*>(&ins);
+            auto store = cast<StoreInst>(&ins);
             auto lv = store->get_lval();
             auto cv = crossVars[lv];
             if (varDef[lv].size() > 1 && (!cv.size() || cv.back() != &bb)) {
@@ -118,13 +118,13 @@ void Mem2Reg::rename(BasicBlock* bb) {
             auto var = phiToVar[&ins];         // 获取局部变量
             varStack[var].emplace_back(&ins);  // 记录局部变量的定值
         } else if (ins.is_load()) {
-            auto load = dynamic_cast<LoadInst*>(&ins);
+            auto load = cast<LoadInst>(&ins);
             auto lv = load->get_lval();                         // 获取局部变量
             if (varDef[lv].size() && varStack[lv].size()) {     // 如果是局部变量
                 ins.replace_all_use_with(varStack[lv].back());  // 替换所有的使用
             }
         } else if (ins.is_store()) {
-            auto store = dynamic_cast<StoreInst*>(&ins);
+            auto store = cast<StoreInst>(&ins);
             auto lv = store->get_lval();
             if (varDef[lv].size()) {                           // 如果是局部变量
                 varStack[lv].emplace_back(store->get_rval());  // 记录局部变量的定值
@@ -139,7 +139,7 @@ void Mem2Reg::rename(BasicBlock* bb) {
             auto var = phiToVar[&ins];
             auto vs = varStack[var];
             if (vs.size()) {
-                auto phi = dynamic_cast<PhiInst*>(&ins);
+                auto phi = cast<PhiInst>(&ins);
                 phi->add_phi_pair_operand(vs.back(), bb);
             }
         }
@@ -153,7 +153,7 @@ void Mem2Reg::rename(BasicBlock* bb) {
             auto var = phiToVar[&ins];
             varStack[var].pop_back();
         } else if (ins.is_store()) {
-            auto store = dynamic_cast<StoreInst*>(&ins);
+            auto store = cast<StoreInst>(&ins);
             auto lv = store->get_lval();
             if (varDef[lv].size()) {
                 varStack[lv].pop_back();  // 移除最新定值
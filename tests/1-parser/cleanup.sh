@@ -1,2 +1,3 @@
 #!/bin/sh
 rm -rf output_student/*
+rm -rf output_fast_lexer
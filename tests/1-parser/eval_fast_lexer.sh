@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# Compares the tokens of the hand-written lexer (lexer -fast-lexer) with
+# those of the flex scanner in lexical_analyzer.l, for every input of lab 1
+# and for fast_lexer/*.cminus. Each of the scalar, SSE2 and AVX2 scanners is
+# checked; one the CPU does not have is skipped.
+# usage: ./eval_fast_lexer.sh [<build-dir>]
+# The build dir defaults to ../../build. Exits with 1 if any check fails.
+
+CUR_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+BUILD_DIR="$(realpath "${1:-$CUR_DIR/../../build}")"
+OUTPUT_DIR="$CUR_DIR/output_fast_lexer"
+LEXER="$BUILD_DIR/lexer"
+
+mkdir -p "$OUTPUT_DIR"
+fails=0
+
+scanners=()
+for scanner in scalar sse2 avx2; do
+    if "$LEXER" -fast-lexer=$scanner /dev/null >/dev/null 2>&1; then
+        scanners+=($scanner)
+    else
+        echo "[info] $scanner: not available, skipped"
+    fi
+done
+
+for testcase in "$CUR_DIR"/input/*/*.cminus "$CUR_DIR"/fast_lexer/*.cminus; do
+    dir=$(basename "$(dirname "$testcase")")
+    name=$(basename "$testcase" .cminus)
+    out="$OUTPUT_DIR/${dir}_$name"
+    echo "[info] $dir/$name"
+    "$LEXER" "$testcase" >"$out.flex"
+    for scanner in "${scanners[@]}"; do
+        "$LEXER" -fast-lexer=$scanner "$testcase" >"$out.$scanner"
+        if ! diff -q "$out.flex" "$out.$scanner" >/dev/null; then
+            printf "\033[1;31m[fail]\033[0m %s: %s differs from flex\n" \
+                "$dir/$name" $scanner
+            fails=$((fails + 1))
+        fi
+    done
+done
+
+if [ $fails -eq 0 ]; then
+    echo "[info] All checks passed."
+else
+    echo "[info] $fails check(s) failed."
+    exit 1
+fi
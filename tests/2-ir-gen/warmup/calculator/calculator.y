@@ -90,19 +90,17 @@ syntax_tree *parse(const char *input_path) {
 }
 
 syntax_tree_node *node(const char *name, int children_num, ...) {
-    syntax_tree_node *p = new_syntax_tree_node(name);
-    syntax_tree_node *child;
     if (children_num == 0) {
-        child = new_syntax_tree_node("epsilon");
-        syntax_tree_add_child(p, child);
-    } else {
-        va_list ap;
-        va_start(ap, children_num);
-        for (int i = 0; i < children_num; ++i) {
-            child = va_arg(ap, syntax_tree_node *);
-            syntax_tree_add_child(p, child);
-        }
-        va_end(ap);
+        syntax_tree_node *p = new_syntax_tree_node(gt, name, 1);
+        p->children[0] = new_syntax_tree_node(gt, "epsilon", 0);
+        return p;
     }
+
+    syntax_tree_node *p = new_syntax_tree_node(gt, name, children_num);
+    va_list ap;
+    va_start(ap, children_num);
+    for (int i = 0; i < children_num; ++i)
+        p->children[i] = va_arg(ap, syntax_tree_node *);
+    va_end(ap);
     return p;
 }
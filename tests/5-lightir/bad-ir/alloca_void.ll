@@ -0,0 +1,6 @@
+; expect: 4:15: invalid pointer element type
+define void @f() {
+entry:
+  %x = alloca void
+  ret void
+}
@@ -0,0 +1,6 @@
+; expect: block '%entry' does not end with a terminator
+define void @f() {
+entry:
+next:
+  ret void
+}
@@ -0,0 +1,2 @@
+; expect: 2:13: invalid global variable type
+@g = global void zeroinitializer
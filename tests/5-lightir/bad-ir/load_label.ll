@@ -0,0 +1,7 @@
+; expect: 5:13: invalid pointer element type
+@g = global i32 zeroinitializer
+define void @f() {
+entry:
+  %x = load label, i32* @g
+  ret void
+}
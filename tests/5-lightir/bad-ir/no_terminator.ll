@@ -0,0 +1,5 @@
+; expect: block '%entry' does not end with a terminator
+define i32 @f() {
+entry:
+  %x = add i32 1, 2
+}
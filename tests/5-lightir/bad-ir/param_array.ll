@@ -0,0 +1,5 @@
+; expect: invalid parameter type
+define void @f([2 x i32] %a) {
+entry:
+  ret void
+}
@@ -0,0 +1,2 @@
+; expect: invalid pointer element type
+declare void* @f()
@@ -0,0 +1,5 @@
+; expect: invalid return type
+define i32* @f() {
+entry:
+  ret i32* null
+}
@@ -0,0 +1,6 @@
+; expect: '%x' is used by its own definition
+define i32 @f() {
+entry:
+  %x = add i32 %x, 1
+  ret i32 %x
+}
@@ -0,0 +1,44 @@
+; ModuleID = 'cminus'
+source_filename = "loop_if.cminus"
+
+declare i32 @input()
+
+declare void @output(i32)
+
+declare void @outputFloat(float)
+
+declare void @neg_idx_except()
+
+define i32 @main() {
+label_00000000:
+  %op0 = alloca i32
+  store i32 0, i32* %op0
+  br label %label_00000001
+label_00000001:                                                ; preds = %label_00000000, %label_00000006
+  %op1 = load i32, i32* %op0
+  %op2 = icmp slt i32 %op1, 10
+  %op3 = zext i1 %op2 to i32
+  %op4 = icmp ne i32 %op3, 0
+  br i1 %op4, label %label_00000002, label %label_00000003
+label_00000002:                                                ; preds = %label_00000001
+  %op5 = load i32, i32* %op0
+  %op6 = icmp sgt i32 %op5, 3
+  %op7 = zext i1 %op6 to i32
+  %op8 = icmp ne i32 %op7, 0
+  br i1 %op8, label %label_00000004, label %label_00000005
+label_00000003:                                                ; preds = %label_00000001
+  %op9 = load i32, i32* %op0
+  ret i32 %op9
+label_00000004:                                                ; preds = %label_00000002
+  %op10 = load i32, i32* %op0
+  %op11 = add i32 %op10, 2
+  store i32 %op11, i32* %op0
+  br label %label_00000006
+label_00000005:                                                ; preds = %label_00000002
+  %op12 = load i32, i32* %op0
+  %op13 = add i32 %op12, 1
+  store i32 %op13, i32* %op0
+  br label %label_00000006
+label_00000006:                                                ; preds = %label_00000004, %label_00000005
+  br label %label_00000001
+}
@@ -0,0 +1,23 @@
+; two nested loops whose exits meet in one block
+define i32 @main() {
+entry:
+  %op0 = alloca i32
+  store i32 0, i32* %op0
+  br label %outer
+outer:
+  %op1 = load i32, i32* %op0
+  %op2 = icmp slt i32 %op1, 10
+  br i1 %op2, label %inner, label %done
+inner:
+  %op3 = load i32, i32* %op0
+  %op4 = add i32 %op3, 1
+  store i32 %op4, i32* %op0
+  %op5 = icmp slt i32 %op4, 5
+  br i1 %op5, label %inner, label %latch
+latch:
+  %op6 = icmp eq i32 %op4, 7
+  br i1 %op6, label %done, label %outer
+done:
+  %op7 = load i32, i32* %op0
+  ret i32 %op7
+}
@@ -0,0 +1,18 @@
+; a block that branches to itself, and a block no path reaches
+define void @spin(i32 %arg0) {
+entry:
+  br label %loop
+loop:
+  %op0 = icmp sgt i32 %arg0, 0
+  br i1 %op0, label %loop, label %exit
+exit:
+  ret void
+dead:
+  br label %exit
+}
+
+define i32 @main() {
+entry:
+  call void @spin(i32 3)
+  ret i32 0
+}
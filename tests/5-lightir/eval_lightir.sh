@@ -0,0 +1,187 @@
+#!/bin/bash
+
+# Checks of LightIR: the .ll and bitcode readers, the linker and the
+# analyses of lightir-opt.
+# usage: ./eval_lightir.sh [<build-dir>]
+# The build dir defaults to ../../build. Exits with 1 if any check fails.
+
+CUR_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+BUILD_DIR="$(realpath "${1:-$CUR_DIR/../../build}")"
+OUTPUT_DIR="$CUR_DIR/output"
+OPT="$BUILD_DIR/lightir-opt"
+CMINUSFC="$BUILD_DIR/cminusfc"
+
+mkdir -p "$OUTPUT_DIR"
+fails=0
+
+fail() {
+    printf "\033[1;31m[fail]\033[0m %s\n" "$1"
+    fails=$((fails + 1))
+}
+
+# Dominator tree and dominance frontiers of each dominators/*.ll, compared
+# with the .dom file next to it.
+check_dominators() {
+    for ll in "$CUR_DIR"/dominators/*.ll; do
+        name=$(basename "$ll" .ll)
+        out="$OUTPUT_DIR/$name.dom"
+        echo "[info] dominators: $name"
+        if ! timeout 10 "$OPT" -print-dom "$ll" -o "$out"; then
+            fail "dominators: $name: lightir-opt failed"
+        elif ! diff -q "$out" "${ll%.ll}.dom" >/dev/null; then
+            fail "dominators: $name: differs from $name.dom"
+        fi
+    done
+}
+
+# Every functional case of lab 4 written as bitcode and read back: the
+# module and the assembly from the .lirbc must match those from the source.
+check_bitcode() {
+    for cm in "$CUR_DIR"/../4-mem2reg/functional-cases/*.cminus; do
+        name=$(basename "$cm" .cminus)
+        out="$OUTPUT_DIR/bitcode/$name"
+        mkdir -p "$OUTPUT_DIR/bitcode"
+        echo "[info] bitcode: $name"
+        if ! "$CMINUSFC" -emit-bc "$cm" -o "$out.lirbc" ||
+            ! "$CMINUSFC" -emit-llvm "$cm" -o "$out.src.ll" ||
+            ! "$CMINUSFC" -S "$cm" -o "$out.src.s"; then
+            fail "bitcode: $name: cminusfc failed"
+        elif ! timeout 10 "$OPT" -emit-llvm "$out.lirbc" -o "$out.bc.ll" ||
+            ! timeout 10 "$OPT" -S "$out.lirbc" -o "$out.bc.s"; then
+            fail "bitcode: $name: lightir-opt failed"
+        elif ! diff -q <(grep -v '^source_filename' "$out.src.ll") \
+            <(grep -v '^source_filename' "$out.bc.ll") >/dev/null ||
+            ! diff -q "$out.src.s" "$out.bc.s" >/dev/null; then
+            fail "bitcode: $name: round trip differs from the source"
+        fi
+    done
+}
+
+# The text form of every functional case of lab 4, before and after
+# mem2reg, read by lightir-opt and printed again must not change.
+check_text() {
+    mkdir -p "$OUTPUT_DIR/text"
+    for cm in "$CUR_DIR"/../4-mem2reg/functional-cases/*.cminus; do
+        name=$(basename "$cm" .cminus)
+        for flag in "" -mem2reg; do
+            out="$OUTPUT_DIR/text/$name$flag"
+            echo "[info] text: $name $flag"
+            if ! "$CMINUSFC" $flag -emit-llvm "$cm" -o "$out.ll"; then
+                fail "text: $name $flag: cminusfc failed"
+            elif ! timeout 10 "$OPT" -emit-llvm "$out.ll" -o "$out.out.ll"; then
+                fail "text: $name $flag: lightir-opt failed"
+            elif ! diff -q <(grep -v '^source_filename' "$out.ll") \
+                <(grep -v '^source_filename' "$out.out.ll") >/dev/null; then
+                fail "text: $name $flag: round trip differs from the input"
+            fi
+        done
+    done
+}
+
+# Each bad-ir/*.ll is rejected with the error on its "; expect:" line.
+check_bad_text() {
+    for ll in "$CUR_DIR"/bad-ir/*.ll; do
+        name=$(basename "$ll" .ll)
+        expect=$(sed -n 's/^; expect: //p' "$ll")
+        echo "[info] bad text: $name"
+        timeout 10 "$OPT" -emit-llvm "$ll" -o /dev/null \
+            >"$OUTPUT_DIR/$name.err" 2>&1
+        if [ $? -ne 255 ] || ! grep -qF "$expect" "$OUTPUT_DIR/$name.err"; then
+            fail "bad text: $name: not reported as \"$expect\""
+        fi
+    done
+}
+
+# linker/main.cminus calls functions of lib.cminus and the other way round,
+# and all three files define the global n or total. The linked module is
+# compared with linker/program.ll, also with common.cminus given as bitcode.
+check_linker() {
+    local dir="$CUR_DIR/linker" out="$OUTPUT_DIR/linker"
+    mkdir -p "$out"
+    echo "[info] linker: program"
+    if ! "$CMINUSFC" -emit-bc "$dir/common.cminus" -o "$out/common.lirbc"; then
+        fail "linker: common.cminus: cminusfc failed"
+        return
+    fi
+    for common in "$dir/common.cminus" "$out/common.lirbc"; do
+        if ! "$CMINUSFC" -emit-llvm "$dir/main.cminus" "$dir/lib.cminus" \
+            "$common" -o "$out/program.ll"; then
+            fail "linker: $(basename "$common"): cminusfc failed"
+        elif ! diff -q "$dir/program.ll" \
+            <(grep -v '^source_filename' "$out/program.ll") >/dev/null; then
+            fail "linker: $(basename "$common"): differs from program.ll"
+        fi
+    done
+
+    # a file added to the program, and the error it must cause
+    local cases=(
+        "redef_fib.cminus|redefinition of 'fib'"
+        "float_fib.cminus|conflicting types for 'fib'"
+        "array_n.cminus|conflicting types for 'n'"
+        "var_fib.cminus|'fib' is both a function and a variable"
+        "var_fib.lirbc|'fib' is both a function and a variable"
+    )
+    "$CMINUSFC" -emit-bc "$dir/var_fib.cminus" -o "$out/var_fib.lirbc"
+    for c in "${cases[@]}"; do
+        local file=${c%%|*} expect=${c#*|}
+        local path="$dir/$file"
+        [ -f "$path" ] || path="$out/$file"
+        echo "[info] linker: $file"
+        "$CMINUSFC" -emit-llvm "$dir/main.cminus" "$dir/lib.cminus" \
+            "$dir/common.cminus" "$path" -o /dev/null >"$out/$file.err" 2>&1
+        if [ $? -ne 255 ] || ! grep -qF "$file: $expect" "$out/$file.err"
+        then
+            fail "linker: $file: not reported as \"$expect\""
+        fi
+    done
+}
+
+# Type records that are well formed but name a type the module cannot
+# have; lightir-opt must reject them instead of aborting.
+check_bad_bitcode() {
+    # header: magic ("LIRB") and version, then the number of strings, types,
+    # constants, functions and globals
+    words() { perl -e 'print pack("V*", @ARGV)' 1112688972 1 "$@"; }
+    words 0 2 0 0 0  0  5 0 >"$OUTPUT_DIR/ptr_void.lirbc"
+    words 0 3 0 0 0  2 32  5 0  3 1 0 >"$OUTPUT_DIR/ret_ptr.lirbc"
+    words 0 3 0 0 0  2 32  4 0 2  3 0 1 1 >"$OUTPUT_DIR/arg_array.lirbc"
+    for bc in ptr_void ret_ptr arg_array; do
+        check_bad_bc $bc "invalid type record"
+    done
+
+    # a global named "g": name, element type, is_const and initializer
+    words 1 1 1 0 1  1 103  0  6 0  0 0 0 1 >"$OUTPUT_DIR/global_void.lirbc"
+    words 1 2 1 0 1  1 103  2 32  3 0 0  6 0  0 1 0 1 \
+        >"$OUTPUT_DIR/global_func.lirbc"
+    words 1 1 0 0 1  1 103  2 32  0 0 0 4294967295 \
+        >"$OUTPUT_DIR/global_no_init.lirbc"
+    words 1 2 1 0 1  1 103  2 32  6  6 1  0 0 0 1 \
+        >"$OUTPUT_DIR/global_float_init.lirbc"
+    for bc in global_void global_func global_no_init global_float_init; do
+        check_bad_bc $bc "invalid global variable record"
+    done
+}
+
+# check_bad_bc <name> <message>: $OUTPUT_DIR/<name>.lirbc is rejected
+check_bad_bc() {
+    echo "[info] bad bitcode: $1"
+    timeout 10 "$OPT" -emit-llvm "$OUTPUT_DIR/$1.lirbc" -o /dev/null \
+        >"$OUTPUT_DIR/$1.err" 2>&1
+    if [ $? -ne 255 ] || ! grep -q "$2" "$OUTPUT_DIR/$1.err"; then
+        fail "bad bitcode: $1: not reported as \"$2\""
+    fi
+}
+
+check_dominators
+check_text
+check_bad_text
+check_bitcode
+check_bad_bitcode
+check_linker
+
+if [ $fails -eq 0 ]; then
+    echo "[info] All checks passed."
+else
+    echo "[info] $fails check(s) failed."
+    exit 1
+fi
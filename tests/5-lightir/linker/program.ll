@@ -0,0 +1,86 @@
+; ModuleID = 'cminus'
+
+@n = global i32 zeroinitializer
+@total = global i32 zeroinitializer
+declare i32 @input()
+
+declare void @output(i32)
+
+declare void @outputFloat(float)
+
+declare void @neg_idx_except()
+
+define i32 @fib(i32 %arg0) {
+label_00000000:
+  %op1 = alloca i32
+  store i32 %arg0, i32* %op1
+  %op2 = load i32, i32* %op1
+  %op3 = icmp slt i32 %op2, 2
+  %op4 = zext i1 %op3 to i32
+  %op5 = icmp ne i32 %op4, 0
+  br i1 %op5, label %label_00000001, label %label_00000002
+label_00000001:                                                ; preds = %label_00000000
+  %op6 = load i32, i32* %op1
+  ret i32 %op6
+label_00000002:                                                ; preds = %label_00000000
+  br label %label_00000003
+label_00000003:                                                ; preds = %label_00000002
+  %op7 = load i32, i32* %op1
+  %op8 = sub i32 %op7, 1
+  %op9 = call i32 @fib(i32 %op8)
+  %op10 = load i32, i32* %op1
+  %op11 = sub i32 %op10, 2
+  %op12 = call i32 @fib(i32 %op11)
+  %op13 = add i32 %op9, %op12
+  ret i32 %op13
+}
+define void @main() {
+label_00000004:
+  %op0 = alloca i32
+  store i32 10, i32* @n
+  store i32 0, i32* %op0
+  br label %label_00000005
+label_00000005:                                                ; preds = %label_00000004, %label_00000006
+  %op1 = load i32, i32* %op0
+  %op2 = load i32, i32* @n
+  %op3 = icmp slt i32 %op1, %op2
+  %op4 = zext i1 %op3 to i32
+  %op5 = icmp ne i32 %op4, 0
+  br i1 %op5, label %label_00000006, label %label_00000007
+label_00000006:                                                ; preds = %label_00000005
+  %op6 = load i32, i32* %op0
+  %op7 = call i32 @fib(i32 %op6)
+  call void @accumulate(i32 %op7)
+  %op8 = load i32, i32* %op0
+  %op9 = add i32 %op8, 1
+  store i32 %op9, i32* %op0
+  br label %label_00000005
+label_00000007:                                                ; preds = %label_00000005
+  %op10 = load i32, i32* @total
+  call void @output(i32 %op10)
+  %op11 = call float @scale(float 0x4004000000000000)
+  call void @outputFloat(float %op11)
+  ret void
+}
+define void @accumulate(i32 %arg0) {
+label_00000000:
+  %op1 = alloca i32
+  store i32 %arg0, i32* %op1
+  %op2 = load i32, i32* @total
+  %op3 = load i32, i32* %op1
+  %op4 = load i32, i32* @n
+  %op5 = mul i32 %op3, %op4
+  %op6 = add i32 %op2, %op5
+  store i32 %op6, i32* @total
+  ret void
+}
+define float @scale(float %arg0) {
+label_00000001:
+  %op1 = alloca float
+  store float %arg0, float* %op1
+  %op2 = load float, float* %op1
+  %op3 = call i32 @fib(i32 5)
+  %op4 = sitofp i32 %op3 to float
+  %op5 = fmul float %op2, %op4
+  ret float %op5
+}